@@ -7,6 +7,7 @@ include(cmake/CPM.cmake)
 find_package(Catch2 QUIET)
 find_package(spdlog QUIET)
 find_package(Boost QUIET)
+find_package(Threads REQUIRED)
 
 message(STATUS "Catch2_FOUND: ${Catch2_FOUND}")
 message(STATUS "spdlog_FOUND: ${spdlog_FOUND}")
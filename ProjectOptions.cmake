@@ -20,6 +20,7 @@ endmacro()
 macro(zephyr_setup_options)
   option(zephyr_ENABLE_HARDENING "Enable hardening" ON)
   option(zephyr_ENABLE_COVERAGE "Enable coverage reporting" ON)
+  option(zephyr_BUILD_BENCHMARKS "Build the benchmarks" OFF)
   cmake_dependent_option(
     zephyr_ENABLE_GLOBAL_HARDENING
     "Attempt to push hardening options to built dependencies"
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Core/Events/EventHandler.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/World.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+    struct Position
+    {
+            float x;
+            float y;
+    };
+
+    struct Velocity
+    {
+            float x;
+            float y;
+    };
+
+    constexpr std::size_t movingEntities = 300000;
+
+    void populate(Engine::Core::World &aWorld)
+    {
+        aWorld.registerComponents<Position, Velocity>();
+        const auto entities = aWorld.createEntities(movingEntities);
+
+        aWorld.emplaceComponents<Position>(entities, 0.F, 0.F);
+        aWorld.emplaceComponents<Velocity>(entities, 1.F, 2.F);
+    }
+
+    void move(Engine::Core::World & /*world*/, double deltaTime, std::size_t /*idx*/, Position &position,
+              const Velocity &velocity)
+    {
+        position.x += velocity.x * static_cast<float>(deltaTime);
+        position.y += velocity.y * static_cast<float>(deltaTime);
+    }
+
+    constexpr std::size_t fanOut = 1000;
+
+    /**
+     * @brief Spawn fanOut empty jobs and wait for all of them
+     */
+    void fanOutFanIn(Engine::Core::JobSystem &aJobs)
+    {
+        std::vector<Engine::Core::JobHandle> handles;
+
+        handles.reserve(fanOut);
+        for (std::size_t idx = 0; idx < fanOut; idx++) {
+            handles.push_back(aJobs.spawn([]() {}));
+        }
+        for (const auto &handle : handles) {
+            aJobs.wait(handle);
+        }
+    }
+
+    /**
+     * @brief The worker counts to compare: 0 (calling thread only), then powers of two up to every core
+     */
+    std::vector<std::size_t> workerCounts()
+    {
+        const std::size_t cores = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::vector<std::size_t> counts;
+
+        for (std::size_t threads = 1; threads < cores; threads *= 2) {
+            counts.push_back(threads - 1);
+        }
+        counts.push_back(cores - 1);
+        return counts;
+    }
+    struct PushedEvent
+    {
+            std::size_t value;
+    };
+
+    /**
+     * @brief The event list of EventHandler before it got a queue per producer thread, as a baseline
+     */
+    struct MutexEvents
+    {
+            std::mutex mutex;
+            std::vector<PushedEvent> events;
+
+            void pushEvent(const PushedEvent &aEvent)
+            {
+                const std::lock_guard lock(mutex);
+
+                events.push_back(aEvent);
+            }
+    };
+
+    constexpr std::size_t pushedEvents = 1 << 18;
+
+    /**
+     * @brief Push pushedEvents events split between fresh producer threads
+     */
+    template<typename Events>
+    void pushFrom(Events &aEvents, std::size_t aProducers)
+    {
+        std::vector<std::thread> producers;
+
+        for (std::size_t producer = 0; producer < aProducers; producer++) {
+            producers.emplace_back([&aEvents, aProducers]() {
+                for (std::size_t idx = 0; idx < pushedEvents / aProducers; idx++) {
+                    aEvents.pushEvent(PushedEvent {idx});
+                }
+            });
+        }
+        for (auto &producer : producers) {
+            producer.join();
+        }
+    }
+} // namespace
+
+TEST_CASE("Query iteration scaling", "[!benchmark]")
+{
+    Engine::Core::World world;
+
+    populate(world);
+    auto &cached = world.registerQuery<Position, Velocity>();
+
+    BENCHMARK("forEach, threads: 1")
+    {
+        cached.forEach(1, move);
+    };
+    for (const auto workers : workerCounts()) {
+        Engine::Core::JobSystem jobs(workers);
+
+        BENCHMARK("forEachParallel, threads: " + std::to_string(workers + 1))
+        {
+            cached.forEachParallel(1, move, Engine::Core::JobSystem::defaultGrain, jobs);
+        };
+    }
+    BENCHMARK("uncached forEachParallel, shared job system")
+    {
+        world.query<Position, Velocity>().forEachParallel(1, move);
+    };
+}
+
+TEST_CASE("Job system overhead", "[!benchmark]")
+{
+    for (const auto workers : workerCounts()) {
+        Engine::Core::JobSystem jobs(workers);
+        const std::string threads = ", threads: " + std::to_string(workers + 1);
+
+        BENCHMARK("spawn and wait one job" + threads)
+        {
+            jobs.wait(jobs.spawn([]() {}));
+        };
+        BENCHMARK("chain of 100 continuations" + threads)
+        {
+            auto last = jobs.spawn([]() {});
+
+            for (std::size_t idx = 1; idx < 100; idx++) {
+                last = jobs.spawnAfter(last, []() {});
+            }
+            jobs.wait(last);
+        };
+        // spawned from the calling thread: the jobs go through the injection queue
+        BENCHMARK("fan-out/fan-in of 1000 jobs from outside" + threads)
+        {
+            fanOutFanIn(jobs);
+        };
+        // spawned from a worker: the jobs go in its own deque and the other workers steal them
+        BENCHMARK("fan-out/fan-in of 1000 jobs from a job" + threads)
+        {
+            jobs.wait(jobs.spawn([&jobs]() { fanOutFanIn(jobs); }));
+        };
+    }
+}
+
+TEST_CASE("Event push contention", "[!benchmark]")
+{
+    for (const std::size_t producers : {std::size_t {1}, std::size_t {4}, std::size_t {16}}) {
+        const std::string threads = ", producers: " + std::to_string(producers);
+
+        BENCHMARK("EventHandler push then drain" + threads)
+        {
+            Engine::Event::EventHandler<PushedEvent> handler;
+
+            pushFrom(handler, producers);
+            return handler.drain().size();
+        };
+        BENCHMARK("mutex and vector push" + threads)
+        {
+            MutexEvents events;
+
+            pushFrom(events, producers);
+            return events.events.size();
+        };
+    }
+}
+
+TEST_CASE("Event removal", "[!benchmark]")
+{
+    constexpr std::size_t queued = 10000;
+    std::vector<std::size_t> every3rd;
+
+    for (std::size_t idx = 0; idx < queued; idx += 3) {
+        every3rd.push_back(idx);
+    }
+    // a full handler per run, the removals being measured on the same list
+    const auto fill = [](std::size_t aRuns) {
+        std::vector<Engine::Event::EventHandler<PushedEvent>> handlers(aRuns);
+
+        for (auto &handler : handlers) {
+            for (std::size_t idx = 0; idx < queued; idx++) {
+                handler.pushEvent(PushedEvent {idx});
+            }
+            handler.drain();
+        }
+        return handlers;
+    };
+
+    BENCHMARK_ADVANCED("erase one index at a time")(Catch::Benchmark::Chronometer meter)
+    {
+        auto handlers = fill(static_cast<std::size_t>(meter.runs()));
+
+        meter.measure([&handlers, &every3rd](int run) {
+            auto &handler = handlers[static_cast<std::size_t>(run)];
+
+            for (std::size_t idx = 0; idx < every3rd.size(); idx++) {
+                handler.removeEvent(every3rd[idx] - idx);
+            }
+        });
+    };
+    BENCHMARK_ADVANCED("removeEvents, stable")(Catch::Benchmark::Chronometer meter)
+    {
+        auto handlers = fill(static_cast<std::size_t>(meter.runs()));
+
+        meter.measure(
+            [&handlers, &every3rd](int run) { handlers[static_cast<std::size_t>(run)].removeEvents(every3rd); });
+    };
+    BENCHMARK_ADVANCED("removeEvents, swap-remove")(Catch::Benchmark::Chronometer meter)
+    {
+        auto handlers = fill(static_cast<std::size_t>(meter.runs()));
+
+        meter.measure([&handlers, &every3rd](int run) {
+            handlers[static_cast<std::size_t>(run)].removeEvents(every3rd, Engine::Event::RemovalMode::SwapRemove);
+        });
+    };
+    BENCHMARK_ADVANCED("removeEventsIf, stable")(Catch::Benchmark::Chronometer meter)
+    {
+        auto handlers = fill(static_cast<std::size_t>(meter.runs()));
+
+        meter.measure([&handlers](int run) {
+            return handlers[static_cast<std::size_t>(run)].removeEventsIf(
+                [](const PushedEvent &aEvent) { return aEvent.value % 3 == 0; });
+        });
+    };
+}
@@ -1,8 +1,16 @@
 #ifndef APP_HPP_
 #define APP_HPP_
 
+#include <algorithm>
+#include <cstddef>
+#include <exception>
 #include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 #include "Exception.hpp"
+#include "FixedTimestep.hpp"
+#include "JobSystem.hpp"
 #include "World.hpp"
 #include <boost/container/flat_map.hpp>
 
@@ -19,10 +27,13 @@ namespace Engine {
         public:
             using world = std::unique_ptr<Core::World>;
             using worlds = boost::container::flat_map<Key, world>;
+            using timesteps = boost::container::flat_map<Key, Core::FixedTimestep>;
+            using failures = std::vector<std::pair<Key, std::exception_ptr>>;
 
         private:
             worlds _worlds;
             Key _currentWorld;
+            timesteps _timesteps;
 
         public:
 #pragma region constructors / destructors
@@ -90,6 +101,107 @@ namespace Engine {
                     throw AppExceptionKeyNotFound("The key doesn't exist");
                 }
                 _worlds.erase(aKey);
+                _timesteps.erase(aKey);
+            }
+
+            /**
+             * @brief Tick a world at a fixed rate in runAll instead of once per call
+             * @details Each tick runs the systems of the world once with one step as frame time, see FixedTimestep
+             * @throw AppExceptionKeyNotFound If the key doesn't exist
+             * @param aKey The key of the world
+             * @param aHertz The number of ticks per second, 0 to tick once per call
+             * @param aMaxSteps The max number of ticks in one call
+             */
+            void setTickRate(const Key &aKey, double aHertz,
+                             std::size_t aMaxSteps = Core::FixedTimestep::defaultMaxSteps)
+            {
+                if (_worlds.find(aKey) == _worlds.end()) {
+                    throw AppExceptionKeyNotFound("The key doesn't exist");
+                }
+                _timesteps[aKey] = Core::FixedTimestep(aHertz, aMaxSteps);
+            }
+
+            /**
+             * @brief Tick every world in parallel, see runAll(std::span<const Key>, double, Core::JobSystem &)
+             */
+            failures runAll(double aElapsed, Core::JobSystem &aJobs = Core::JobSystem::getShared())
+            {
+                std::vector<Key> keys;
+
+                keys.reserve(_worlds.size());
+                for (const auto &[key, value] : _worlds) {
+                    keys.push_back(key);
+                }
+                return runAll(keys, aElapsed, aJobs);
+            }
+
+            /**
+             * @brief Tick a set of worlds in parallel, each world being one job running World::runSystems
+             * @details A world without tick rate runs its systems once with aElapsed, the other ones as many ticks as
+             * their rate allows. A world throwing stops ticking for this call, the other ones go on: the exceptions
+             * are returned instead of thrown. The systems of the worlds run on the shared JobSystem, the jobs waiting
+             * for them run the other queued jobs meanwhile. The worlds must not share state outside of the App (like
+             * the process wide EventManager, each World having its own) without synchronizing it.
+             * @throw AppExceptionKeyNotFound If one of the keys doesn't exist, before any world runs
+             * @param aKeys The keys of the worlds to tick, a key given twice is ticked once
+             * @param aElapsed The time since the previous call in milliseconds
+             * @param aJobs The job system to run the worlds on
+             * @return failures The key and the exception of each world which threw, sorted by key
+             */
+            failures runAll(std::span<const Key> aKeys, double aElapsed,
+                            Core::JobSystem &aJobs = Core::JobSystem::getShared())
+            {
+                struct Run
+                {
+                        Key key;
+                        Core::World *world;
+                        std::size_t steps;
+                        double step;
+                        std::exception_ptr error;
+                };
+                std::vector<Key> keys(aKeys.begin(), aKeys.end());
+                std::vector<Run> runs;
+                std::vector<Core::JobHandle> handles;
+                failures failed;
+
+                std::sort(keys.begin(), keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+                for (const auto &key : keys) {
+                    if (_worlds.find(key) == _worlds.end()) {
+                        throw AppExceptionKeyNotFound("The key doesn't exist");
+                    }
+                }
+                runs.reserve(keys.size());
+                for (const auto &key : keys) {
+                    auto &timestep = _timesteps[key];
+                    const std::size_t steps = timestep.advance(aElapsed);
+
+                    if (_worlds[key] && steps > 0) {
+                        runs.push_back({key, _worlds[key].get(), steps,
+                                        timestep.isFixed() ? timestep.getStep() : aElapsed, nullptr});
+                    }
+                }
+                handles.reserve(runs.size());
+                for (auto &run : runs) {
+                    handles.push_back(aJobs.spawn([&run]() {
+                        try {
+                            for (std::size_t step = 0; step < run.steps; step++) {
+                                run.world->runSystems(run.step);
+                            }
+                        } catch (...) {
+                            run.error = std::current_exception();
+                        }
+                    }));
+                }
+                for (const auto &handle : handles) {
+                    aJobs.wait(handle);
+                }
+                for (auto &run : runs) {
+                    if (run.error) {
+                        failed.emplace_back(run.key, std::move(run.error));
+                    }
+                }
+                return failed;
             }
 
             /**
@@ -0,0 +1,515 @@
+#ifndef ARCHETYPE_HPP_
+#define ARCHETYPE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "ComponentRegistry.hpp"
+#include "Exception.hpp"
+#include "Signature.hpp"
+#include <boost/container/flat_map.hpp>
+
+namespace Engine::Core {
+    DEFINE_EXCEPTION(ArchetypeException);
+    DEFINE_EXCEPTION_FROM(ArchetypeExceptionUnknownComponent, ArchetypeException);
+    DEFINE_EXCEPTION_FROM(ArchetypeExceptionUnknownEntity, ArchetypeException);
+    DEFINE_EXCEPTION_FROM(ArchetypeExceptionTooManyComponents, ArchetypeException);
+
+    /**
+     * @brief Type erased operations needed to store a component type in an archetype column
+     */
+    struct ComponentInfo
+    {
+            std::size_t size = 0;
+            std::size_t align = 0;
+            /// Move construct the component at aDst from aSrc, then destroy aSrc
+            void (*relocate)(void *aDst, void *aSrc) = nullptr;
+            void (*destroy)(void *aPtr) = nullptr;
+
+            template<typename Component>
+            static ComponentInfo create()
+            {
+                return ComponentInfo {sizeof(Component), alignof(Component),
+                                      [](void *aDst, void *aSrc) {
+                                          auto *src = static_cast<Component *>(aSrc);
+
+                                          new (aDst) Component(std::move(*src));
+                                          src->~Component();
+                                      },
+                                      [](void *aPtr) {
+                                          static_cast<Component *>(aPtr)->~Component();
+                                      }};
+            }
+    };
+
+    /**
+     * @brief An archetype stores every entity owning exactly the same set of components
+     * @details The entities live in fixed size chunks (chunkSize bytes). Inside a chunk each component is a contiguous
+     * column (SoA), next to a column holding the entity ids. Every chunk but the last one is always full: removing a
+     * row moves the last row of the archetype in the hole.
+     */
+    class Archetype final
+    {
+        public:
+            using id = std::size_t;
+
+            static constexpr std::size_t chunkSize = 16 * 1024;
+            static constexpr std::size_t chunkAlign = 64;
+            static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+            struct ChunkDeleter
+            {
+                    void operator()(std::byte *aData) const
+                    {
+                        ::operator delete(aData, std::align_val_t {chunkAlign});
+                    }
+            };
+
+            struct Chunk
+            {
+                    std::unique_ptr<std::byte, ChunkDeleter> data;
+                    std::size_t count = 0;
+            };
+
+        private:
+            Signature _signature;
+            std::vector<std::size_t> _components;
+            std::vector<ComponentInfo> _infos;
+            std::vector<std::size_t> _offsets;
+            std::size_t _capacity = 0;
+            std::size_t _bytes = chunkSize;
+            std::vector<Chunk> _chunks;
+            boost::container::flat_map<std::size_t, Archetype *> _addEdges;
+            boost::container::flat_map<std::size_t, Archetype *> _removeEdges;
+
+        public:
+#pragma region constructors / destructors
+            /**
+             * @brief Construct a new Archetype object
+             *
+             * @param aSignature The components of the archetype
+             * @param aInfos The informations of every registered component, indexed by component id
+             */
+            Archetype(const Signature &aSignature, const std::vector<ComponentInfo> &aInfos);
+            ~Archetype();
+
+            Archetype(const Archetype &other) = delete;
+            Archetype &operator=(const Archetype &other) = delete;
+
+            Archetype(Archetype &&other) noexcept = delete;
+            Archetype &operator=(Archetype &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            [[nodiscard]] const Signature &getSignature() const
+            {
+                return _signature;
+            }
+
+            /**
+             * @brief Get the number of entities in the archetype
+             *
+             * @return std::size_t The number of entities
+             */
+            [[nodiscard]] std::size_t size() const
+            {
+                return _chunks.empty() ? 0 : (_chunks.size() - 1) * _capacity + _chunks.back().count;
+            }
+
+            /**
+             * @brief Get the number of rows a chunk can hold
+             *
+             * @return std::size_t The capacity of a chunk
+             */
+            [[nodiscard]] std::size_t getChunkCapacity() const
+            {
+                return _capacity;
+            }
+
+            [[nodiscard]] std::size_t getChunkCount() const
+            {
+                return _chunks.size();
+            }
+
+            [[nodiscard]] std::size_t getChunkSize(std::size_t aChunk) const
+            {
+                return _chunks[aChunk].count;
+            }
+
+            /**
+             * @brief Get the column of the entity ids of a chunk
+             *
+             * @param aChunk The index of the chunk
+             * @return id* The first entity id of the chunk
+             */
+            id *getEntities(std::size_t aChunk)
+            {
+                return reinterpret_cast<id *>(_chunks[aChunk].data.get());
+            }
+
+            /**
+             * @brief Get the column of a component in a chunk
+             *
+             * @param aChunk The index of the chunk
+             * @param aBit The bit of the component, must be part of the signature
+             * @return void* The first component of the column
+             */
+            void *getColumn(std::size_t aChunk, std::size_t aBit)
+            {
+                return _chunks[aChunk].data.get() + _offsets[aBit];
+            }
+
+            template<typename Component>
+            Component *getColumn(std::size_t aChunk, std::size_t aBit)
+            {
+                return static_cast<Component *>(getColumn(aChunk, aBit));
+            }
+
+            /**
+             * @brief Get a component of a row
+             *
+             * @param aChunk The index of the chunk
+             * @param aRow The row in the chunk
+             * @param aBit The bit of the component, must be part of the signature
+             * @return void* The component
+             */
+            void *getComponent(std::size_t aChunk, std::size_t aRow, std::size_t aBit)
+            {
+                return static_cast<std::byte *>(getColumn(aChunk, aBit)) + aRow * _infos[aBit].size;
+            }
+
+            /**
+             * @brief Reserve a row at the end of the archetype, its components are left unconstructed
+             *
+             * @param aEntity The entity owning the row
+             * @return std::pair<std::size_t, std::size_t> The chunk and the row
+             */
+            std::pair<std::size_t, std::size_t> allocateRow(id aEntity);
+
+            /**
+             * @brief Fill a row whose components were already destroyed or moved out with the last row
+             *
+             * @param aChunk The chunk of the row
+             * @param aRow The row
+             * @return id The entity moved in the row, npos if the row was the last one
+             */
+            id removeRow(std::size_t aChunk, std::size_t aRow);
+
+            /**
+             * @brief Destroy the components of a row
+             *
+             * @param aChunk The chunk of the row
+             * @param aRow The row
+             */
+            void destroyRow(std::size_t aChunk, std::size_t aRow);
+
+            /**
+             * @brief Get the cached archetype reached by adding (or removing) a component
+             *
+             * @param aBit The bit of the component
+             * @param aAdd true for the add edge, false for the remove edge
+             * @return Archetype* The archetype or nullptr if the edge isn't cached yet
+             */
+            [[nodiscard]] Archetype *getEdge(std::size_t aBit, bool aAdd) const;
+
+            void setEdge(std::size_t aBit, bool aAdd, Archetype *aArchetype);
+
+        private:
+            /**
+             * @brief Place the columns of a chunk holding aCapacity rows
+             *
+             * @param aCapacity The number of rows
+             * @return std::size_t The number of bytes needed by the chunk
+             */
+            std::size_t computeLayout(std::size_t aCapacity);
+#pragma endregion methods
+    };
+
+    /**
+     * @brief Archetype based storage of the components of a World
+     * @details The bit of a component type in a signature is its ComponentRegistry id, each set of components gets an
+     * Archetype. Adding or removing a component moves the entity to the archetype of its new component set, queries
+     * iterate the columns of the matching archetypes chunk by chunk.
+     */
+    class ArchetypeStorage final
+    {
+        public:
+            using id = std::size_t;
+
+            struct EntityLocation
+            {
+                    Archetype *archetype = nullptr;
+                    std::size_t chunk = 0;
+                    std::size_t row = 0;
+            };
+
+        private:
+            std::vector<ComponentInfo> _infos;
+            std::vector<std::unique_ptr<Archetype>> _archetypes;
+            boost::container::flat_map<Signature, Archetype *> _archetypesBySignature;
+            std::vector<EntityLocation> _locations;
+
+        public:
+#pragma region constructors / destructors
+            ArchetypeStorage();
+            ~ArchetypeStorage() = default;
+
+            ArchetypeStorage(const ArchetypeStorage &other) = delete;
+            ArchetypeStorage &operator=(const ArchetypeStorage &other) = delete;
+
+            ArchetypeStorage(ArchetypeStorage &&other) noexcept = delete;
+            ArchetypeStorage &operator=(ArchetypeStorage &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Register a component type
+             * @throw ArchetypeExceptionTooManyComponents if the component id doesn't fit in a Signature
+             * @tparam Component The type of the component
+             * @return std::size_t The bit of the component
+             */
+            template<typename Component>
+            std::size_t registerComponent()
+            {
+                const auto bit = ComponentRegistry::getId<Component>();
+
+                if (bit >= Signature::capacity) {
+                    throw ArchetypeExceptionTooManyComponents("Too many components, raise ZEPHYR_MAX_COMPONENTS");
+                }
+                if (alignof(Component) > Archetype::chunkAlign) {
+                    throw ArchetypeException("Component alignment is bigger than the chunk alignment");
+                }
+                if (bit >= _infos.size()) {
+                    _infos.resize(bit + 1);
+                }
+                _infos[bit] = ComponentInfo::create<Component>();
+                return bit;
+            }
+
+            /**
+             * @brief Get the bit of a component
+             * @throw ArchetypeExceptionUnknownComponent if the component isn't registered
+             * @tparam Component The type of the component
+             * @return std::size_t The bit of the component
+             */
+            template<typename Component>
+            [[nodiscard]] std::size_t getBit() const
+            {
+                const auto bit = ComponentRegistry::getId<Component>();
+
+                if (bit >= _infos.size() || _infos[bit].relocate == nullptr) {
+                    throw ArchetypeExceptionUnknownComponent("Component not registered");
+                }
+                return bit;
+            }
+
+            /**
+             * @brief Put a new entity in the empty archetype
+             *
+             * @param aEntity The id of the entity
+             */
+            void createEntity(id aEntity);
+
+            /**
+             * @brief Destroy the components of an entity and remove it from its archetype
+             *
+             * @param aEntity The id of the entity, ignored if it isn't alive
+             */
+            void killEntity(id aEntity);
+
+            /**
+             * @brief Remove a component from every entity owning it
+             *
+             * @param aBit The bit of the component
+             */
+            void removeComponent(std::size_t aBit);
+
+            /**
+             * @brief Build a component of an entity, moving the entity to its new archetype if needed
+             * @throw ArchetypeExceptionUnknownEntity if the entity isn't alive
+             * @tparam Component The type of the component
+             * @param aEntity The id of the entity
+             * @param aArgs The arguments to pass to the component constructor
+             * @return Component& The component, valid until the next structural change of the archetype
+             */
+            template<typename Component, typename... Args>
+            Component &emplace(id aEntity, Args &&...aArgs)
+            {
+                const std::size_t bit = getBit<Component>();
+                Component value(std::forward<Args>(aArgs)...);
+                auto &location = getLocation(aEntity);
+
+                if (location.archetype->getSignature().test(bit)) {
+                    auto *component = static_cast<Component *>(
+                        location.archetype->getComponent(location.chunk, location.row, bit));
+
+                    *component = std::move(value);
+                    return *component;
+                }
+                moveEntity(aEntity, getNeighbour(*location.archetype, bit, true));
+                return *new (location.archetype->getComponent(location.chunk, location.row, bit))
+                    Component(std::move(value));
+            }
+
+            /**
+             * @brief Remove a component from an entity, moving the entity to its new archetype
+             * @throw ArchetypeExceptionUnknownEntity if the entity isn't alive
+             * @tparam Component The type of the component
+             * @param aEntity The id of the entity
+             */
+            template<typename Component>
+            void remove(id aEntity)
+            {
+                const std::size_t bit = getBit<Component>();
+                auto &location = getLocation(aEntity);
+
+                if (!location.archetype->getSignature().test(bit)) {
+                    return;
+                }
+                moveEntity(aEntity, getNeighbour(*location.archetype, bit, false));
+            }
+
+            /**
+             * @brief Check if an entity owns all the given components
+             *
+             * @tparam Components The components to check
+             * @param aEntity The id of the entity
+             * @return true if the entity is alive and owns all the components
+             */
+            template<typename... Components>
+            [[nodiscard]] bool has(id aEntity) const
+            {
+                if (aEntity >= _locations.size() || _locations[aEntity].archetype == nullptr) {
+                    return false;
+                }
+                const auto &signature = _locations[aEntity].archetype->getSignature();
+
+                return signature.contains(Signature::from(getBit<Components>()...));
+            }
+
+            /**
+             * @brief Get a component of an entity
+             * @throw ArchetypeExceptionUnknownEntity if the entity isn't alive or doesn't own the component
+             * @tparam Component The type of the component
+             * @param aEntity The id of the entity
+             * @return Component& The component
+             */
+            template<typename Component>
+            Component &get(id aEntity)
+            {
+                const std::size_t bit = getBit<Component>();
+                auto &location = getLocation(aEntity);
+
+                if (!location.archetype->getSignature().test(bit)) {
+                    throw ArchetypeExceptionUnknownEntity("Entity doesn't own the component");
+                }
+                return *static_cast<Component *>(location.archetype->getComponent(location.chunk, location.row, bit));
+            }
+
+            /**
+             * @brief Call a function on every entity owning all the given components
+             * @details The matching archetypes are walked chunk by chunk, each component being read from its column
+             * @tparam Components The components to get
+             * @param aFunc The function to call with the entity id and its components
+             */
+            template<typename... Components, typename Func>
+            void forEach(Func &&aFunc)
+            {
+                forEachImpl<Components...>(aFunc, std::index_sequence_for<Components...> {});
+            }
+
+            /**
+             * @brief Call a function on every chunk of the archetypes matching a pair of masks
+             *
+             * @param aInclude The components the archetypes must own
+             * @param aExclude The components the archetypes must not own
+             * @param aFunc The function to call with the archetype and the index of the chunk
+             */
+            template<typename Func>
+            void forEachChunk(const Signature &aInclude, const Signature &aExclude, Func &&aFunc)
+            {
+                for (auto &archetype : _archetypes) {
+                    const auto &signature = archetype->getSignature();
+
+                    if (archetype->size() == 0 || !signature.contains(aInclude) || signature.intersects(aExclude)) {
+                        continue;
+                    }
+                    for (std::size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+                        aFunc(*archetype, chunk);
+                    }
+                }
+            }
+
+            /**
+             * @brief Get the number of archetypes created so far
+             *
+             * @return std::size_t The number of archetypes
+             */
+            [[nodiscard]] std::size_t getArchetypeCount() const
+            {
+                return _archetypes.size();
+            }
+
+        private:
+            template<typename... Components, typename Func, std::size_t... Idx>
+            void forEachImpl(Func &aFunc, std::index_sequence<Idx...> /*unused*/)
+            {
+                const std::array<std::size_t, sizeof...(Components)> bits {getBit<Components>()...};
+                const auto required = Signature::from(bits[Idx]...);
+
+                for (auto &archetype : _archetypes) {
+                    if (archetype->size() == 0 || !archetype->getSignature().contains(required)) {
+                        continue;
+                    }
+                    for (std::size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++) {
+                        const std::size_t count = archetype->getChunkSize(chunk);
+                        const id *entities = archetype->getEntities(chunk);
+                        const std::tuple<Components *...> columns {
+                            archetype->template getColumn<Components>(chunk, bits[Idx])...};
+
+                        for (std::size_t row = 0; row < count; row++) {
+                            aFunc(entities[row], std::get<Idx>(columns)[row]...);
+                        }
+                    }
+                }
+            }
+
+            EntityLocation &getLocation(id aEntity);
+
+            /**
+             * @brief Get the archetype reached by adding or removing a component, create it if needed
+             *
+             * @param aFrom The archetype to start from
+             * @param aBit The bit of the component
+             * @param aAdd true to add the component, false to remove it
+             * @return Archetype& The neighbour archetype
+             */
+            Archetype &getNeighbour(Archetype &aFrom, std::size_t aBit, bool aAdd);
+
+            Archetype &getArchetype(const Signature &aSignature);
+
+            /**
+             * @brief Move an entity to another archetype
+             * @details The components shared by both archetypes are moved, the other ones are destroyed. The
+             * components only present in the destination are left unconstructed.
+             * @param aEntity The id of the entity
+             * @param aTo The destination
+             */
+            void moveEntity(id aEntity, Archetype &aTo);
+
+            /**
+             * @brief Remove the row of an entity whose components were already moved or destroyed
+             *
+             * @param aLocation The location of the entity
+             */
+            void releaseRow(const EntityLocation &aLocation);
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !ARCHETYPE_HPP_ */
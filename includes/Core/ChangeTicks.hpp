@@ -0,0 +1,66 @@
+#ifndef CHANGETICKS_HPP_
+#define CHANGETICKS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Engine::Core {
+    using tick = std::uint32_t;
+
+    /**
+     * @brief The ticks a query compares the change ticks of the components against
+     * @details Each run of a system takes a new tick from its World. A component counts as added / changed for a
+     * system if its tick is newer than the last run of the system and not newer than the current one. The comparison
+     * wraps, it holds as long as a system runs at least once every 2^31 ticks.
+     */
+    struct ChangeTicks final
+    {
+            static constexpr std::size_t noWorld = std::numeric_limits<std::size_t>::max();
+
+            std::size_t world = noWorld;
+            tick lastRun = 0;
+            tick thisRun = 0;
+
+            /**
+             * @brief Check if a change tick is newer than the last run
+             *
+             * @param aTick The tick of the component
+             * @return true if the change happened after the last run and up to this one
+             */
+            [[nodiscard]] constexpr bool isNewer(tick aTick) const
+            {
+                return thisRun - aTick < thisRun - lastRun;
+            }
+
+            /**
+             * @brief Get the ticks of the system running on the calling thread
+             *
+             * @return const ChangeTicks& The ticks, world is noWorld outside of a system
+             */
+            static const ChangeTicks &getCurrent();
+
+            class Scope;
+    };
+
+    /**
+     * @brief Make ticks the current ones of the calling thread until the scope ends
+     */
+    class ChangeTicks::Scope final
+    {
+        private:
+            ChangeTicks _previous;
+
+        public:
+            explicit Scope(const ChangeTicks &aTicks);
+            ~Scope();
+
+            Scope(const Scope &other) = delete;
+            Scope &operator=(const Scope &other) = delete;
+
+            Scope(Scope &&other) noexcept = delete;
+            Scope &operator=(Scope &&other) noexcept = delete;
+    };
+} // namespace Engine::Core
+
+#endif /* !CHANGETICKS_HPP_ */
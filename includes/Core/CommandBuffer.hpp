@@ -0,0 +1,230 @@
+#ifndef COMMANDBUFFER_HPP_
+#define COMMANDBUFFER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+#include "ComponentRegistry.hpp"
+#include "Entity.hpp"
+
+namespace Engine::Core {
+    class World;
+
+    /**
+     * @brief Structural changes recorded to be applied to a World later
+     * @details Creating / killing entities and adding / removing components resizes the storage the queries iterate,
+     * so the systems record them here instead (World::getCommandBuffer gives one buffer per thread) and the World
+     * replays every buffer at its sync point, see World::flushCommands. The commands are grouped by component type:
+     * the entities are created first, then each component type gets its commands sorted by entity, the last one
+     * recorded for an entity winning (removing then adding a component replaces it), then the entities are killed.
+     * The commands aimed at an entity killed in the meantime are dropped.
+     * The vectors keep their capacity between frames.
+     */
+    class CommandBuffer final
+    {
+        public:
+            /**
+             * @brief An entity the buffer will create, components can already be added to it
+             */
+            struct PendingEntity
+            {
+                    std::size_t index;
+            };
+
+        private:
+            struct Target
+            {
+                    Entity entity;
+                    std::size_t pending;
+            };
+
+            /**
+             * @brief Type erased commands of one component type
+             */
+            class Commands
+            {
+                public:
+                    Commands() = default;
+                    virtual ~Commands() = default;
+
+                    Commands(const Commands &other) = delete;
+                    Commands &operator=(const Commands &other) = delete;
+
+                    Commands(Commands &&other) noexcept = delete;
+                    Commands &operator=(Commands &&other) noexcept = delete;
+
+                    virtual void resolve(std::span<const Entity> aCreated) = 0;
+                    virtual void moveInto(CommandBuffer &aOther) = 0;
+                    virtual void apply(World &aWorld) = 0;
+                    virtual void clear() = 0;
+                    [[nodiscard]] virtual bool empty() const = 0;
+            };
+
+            template<typename Component>
+            class ComponentCommands final : public Commands
+            {
+                public:
+                    /// in the order they were recorded, the removals without component
+                    std::vector<std::pair<Target, std::optional<Component>>> commands;
+
+                    void resolve(std::span<const Entity> aCreated) override
+                    {
+                        for (auto &command : commands) {
+                            if (command.first.pending != noPending) {
+                                command.first.entity = aCreated[command.first.pending];
+                                command.first.pending = noPending;
+                            }
+                        }
+                    }
+
+                    void moveInto(CommandBuffer &aOther) override
+                    {
+                        auto &other = aOther.getCommands<Component>();
+
+                        std::move(commands.begin(), commands.end(), std::back_inserter(other.commands));
+                        clear();
+                    }
+
+                    // defined in World.hpp, it needs the complete World
+                    void apply(World &aWorld) override;
+
+                    void clear() override
+                    {
+                        commands.clear();
+                    }
+
+                    [[nodiscard]] bool empty() const override
+                    {
+                        return commands.empty();
+                    }
+            };
+
+            static constexpr std::size_t noPending = std::numeric_limits<std::size_t>::max();
+
+            /// indexed by ComponentRegistry id
+            std::vector<std::unique_ptr<Commands>> _commands;
+            std::size_t _pending = 0;
+            std::vector<Entity> _killed;
+
+        public:
+#pragma region methods
+            /**
+             * @brief Record the creation of an entity
+             *
+             * @return PendingEntity The entity to create, to add components to it
+             */
+            PendingEntity createEntity();
+
+            /**
+             * @brief Record the death of an entity
+             *
+             * @param aEntity The handle of the entity
+             */
+            void killEntity(Entity aEntity);
+
+            /**
+             * @brief Record the addition of a component to an entity
+             *
+             * @tparam Component The type of the component to add
+             * @param aEntity The handle of the entity
+             * @param aComponent The component to add
+             */
+            template<typename Component>
+            void addComponentToEntity(Entity aEntity, Component aComponent)
+            {
+                getCommands<Component>().commands.emplace_back(Target {aEntity, noPending}, std::move(aComponent));
+            }
+
+            /**
+             * @brief Record the addition of a component to an entity the buffer creates
+             *
+             * @tparam Component The type of the component to add
+             * @param aEntity The pending entity
+             * @param aComponent The component to add
+             */
+            template<typename Component>
+            void addComponentToEntity(PendingEntity aEntity, Component aComponent)
+            {
+                getCommands<Component>().commands.emplace_back(Target {Entity(), aEntity.index},
+                                                               std::move(aComponent));
+            }
+
+            /**
+             * @brief Build a component now and record its addition to an entity
+             *
+             * @tparam Component The type of the component to add
+             * @tparam EntityType The type of the entity, Entity or PendingEntity (infered)
+             * @tparam Args The types of the arguments to pass to the component constructor (infered)
+             * @param aEntity The entity
+             * @param aArgs The arguments to pass to the component constructor
+             */
+            template<typename Component, typename EntityType, typename... Args>
+            void emplaceComponentToEntity(EntityType aEntity, Args &&...aArgs)
+            {
+                addComponentToEntity(aEntity, Component(std::forward<Args>(aArgs)...));
+            }
+
+            /**
+             * @brief Record the removal of a component from an entity
+             *
+             * @tparam Component The type of the component to remove
+             * @param aEntity The handle of the entity
+             */
+            template<typename Component>
+            void removeComponentFromEntity(Entity aEntity)
+            {
+                getCommands<Component>().commands.emplace_back(Target {aEntity, noPending}, std::nullopt);
+            }
+
+            /**
+             * @brief Check if the buffer holds no command
+             *
+             * @return true if there is nothing to replay
+             */
+            [[nodiscard]] bool empty() const;
+
+            /**
+             * @brief Drop every command, the capacity is kept
+             */
+            void clear();
+
+            /**
+             * @brief Create the pending entities in a World and move every command to another buffer
+             * @details Done by the World for each per-thread buffer before replaying them all at once
+             * @param aWorld The world to create the entities in
+             * @param aOther The buffer receiving the commands
+             */
+            void submit(World &aWorld, CommandBuffer &aOther);
+
+            /**
+             * @brief Replay the commands on a World then drop them
+             * @details The buffer must not hold pending entities anymore, see submit
+             * @param aWorld The world to change
+             */
+            void apply(World &aWorld);
+
+        private:
+            template<typename Component>
+            ComponentCommands<Component> &getCommands()
+            {
+                const auto id = ComponentRegistry::getId<Component>();
+
+                if (id >= _commands.size()) {
+                    _commands.resize(id + 1);
+                }
+                if (!_commands[id]) {
+                    _commands[id] = std::make_unique<ComponentCommands<Component>>();
+                }
+                return static_cast<ComponentCommands<Component> &>(*_commands[id]);
+            }
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !COMMANDBUFFER_HPP_ */
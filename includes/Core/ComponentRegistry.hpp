@@ -0,0 +1,60 @@
+#ifndef COMPONENTREGISTRY_HPP_
+#define COMPONENTREGISTRY_HPP_
+
+#include <cstddef>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+
+namespace Engine::Core {
+    /**
+     * @brief Give each component type a dense integer id, once per process
+     * @details The ids are given by a type_index -> id map living in the core library, so a plugin asking for a type
+     * gets the same id as the host (as long as both use the same core library). Each binary caches the id of a type
+     * in a function local static the first time it is asked for, so every later call is a single load. The ids are
+     * shared by every World, const / reference qualifiers are ignored.
+     */
+    class ComponentRegistry final
+    {
+        public:
+            ComponentRegistry() = delete;
+
+            /**
+             * @brief Get the id of a component type
+             *
+             * @tparam Component The type of the component
+             * @return std::size_t The id, lower than getCount()
+             */
+            template<typename Component>
+            static std::size_t getId()
+            {
+                return typeId<std::remove_cvref_t<Component>>();
+            }
+
+            /**
+             * @brief Get the id of a component type from its type_index, given if the type has none yet
+             * @details Takes a lock, getId<Component>() only calls it once per type and binary
+             * @param aType The type of the component, without const / reference qualifiers
+             * @return std::size_t The id, lower than getCount()
+             */
+            static std::size_t getId(std::type_index aType);
+
+            /**
+             * @brief Get the number of ids given so far
+             *
+             * @return std::size_t The number of component types seen by the registry
+             */
+            static std::size_t getCount();
+
+        private:
+            template<typename Component>
+            static std::size_t typeId()
+            {
+                static const std::size_t id = getId(std::type_index(typeid(Component)));
+
+                return id;
+            }
+    };
+} // namespace Engine::Core
+
+#endif /* !COMPONENTREGISTRY_HPP_ */
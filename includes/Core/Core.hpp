@@ -2,9 +2,20 @@
 #define CORE_HPP_
 
 #include "App.hpp"
+#include "Archetype.hpp"
+#include "ChangeTicks.hpp"
 #include "Clock.hpp"
+#include "CommandBuffer.hpp"
+#include "ComponentRegistry.hpp"
+#include "Entity.hpp"
+#include "FixedTimestep.hpp"
+#include "JobSystem.hpp"
+#include "QueryCache.hpp"
+#include "QueryFilters.hpp"
+#include "Signature.hpp"
 #include "SparseArray.hpp"
 #include "Systems/GenericSystem.hpp"
 #include "Systems/System.hpp"
+#include "Task.hpp"
 #include "World.hpp"
 #endif /* !CORE_HPP_ */
@@ -0,0 +1,79 @@
+#ifndef ENTITY_HPP_
+#define ENTITY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Engine::Core {
+    /**
+     * @brief Handle on an entity of a World: its index packed with the generation of the index
+     * @details The World bumps the generation of an index each time the entity using it is killed, so a handle kept
+     * after the kill no longer matches the entity reusing the index. The handle converts to its index, which is what
+     * the SparseArrays and the query callbacks use.
+     */
+    class Entity final
+    {
+        public:
+            using index = std::uint32_t;
+            using generation = std::uint32_t;
+
+            static constexpr index invalidIndex = std::numeric_limits<index>::max();
+
+        private:
+            std::uint64_t _value = invalidIndex;
+
+        public:
+#pragma region constructors / destructors
+            constexpr Entity() = default;
+            constexpr Entity(index aIndex, generation aGeneration)
+                : _value(static_cast<std::uint64_t>(aGeneration) << 32U | aIndex)
+            {}
+            ~Entity() = default;
+
+            constexpr Entity(const Entity &other) = default;
+            constexpr Entity &operator=(const Entity &other) = default;
+
+            constexpr Entity(Entity &&other) noexcept = default;
+            constexpr Entity &operator=(Entity &&other) noexcept = default;
+#pragma endregion constructors / destructors
+
+#pragma region operators
+            constexpr bool operator==(const Entity &other) const = default;
+
+            /**
+             * @brief Get the index of the entity
+             *
+             * @return std::size_t The index, used by the SparseArrays and the queries
+             */
+            constexpr operator std::size_t() const // NOLINT(google-explicit-constructor)
+            {
+                return getIndex();
+            }
+#pragma endregion operators
+
+#pragma region methods
+            [[nodiscard]] constexpr index getIndex() const
+            {
+                return static_cast<index>(_value & std::numeric_limits<index>::max());
+            }
+
+            [[nodiscard]] constexpr generation getGeneration() const
+            {
+                return static_cast<generation>(_value >> 32U);
+            }
+
+            /**
+             * @brief Get the packed value of the handle
+             *
+             * @return std::uint64_t The generation in the high 32 bits, the index in the low 32 bits
+             */
+            [[nodiscard]] constexpr std::uint64_t getValue() const
+            {
+                return _value;
+            }
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !ENTITY_HPP_ */
@@ -0,0 +1,123 @@
+#ifndef EVENTCHANNEL_HPP_
+#define EVENTCHANNEL_HPP_
+
+#include <span>
+#include <utility>
+#include "EventHandler.hpp"
+
+namespace Engine::Event {
+    /**
+     * @brief How many swaps the events of a channel stay readable
+     */
+    enum class EventLifetime
+    {
+        /// the events pushed during a frame are read during the next one
+        OneFrame,
+        /// the events are also kept one more frame, for the readers running before the writers
+        TwoFrames,
+    };
+
+    /**
+     * @brief Type erased channel, to swap them all at once
+     */
+    class IEventChannel
+    {
+        public:
+            IEventChannel() = default;
+            virtual ~IEventChannel() = default;
+
+            IEventChannel(const IEventChannel &other) = delete;
+            IEventChannel &operator=(const IEventChannel &other) = delete;
+
+            IEventChannel(IEventChannel &&other) noexcept = delete;
+            IEventChannel &operator=(IEventChannel &&other) noexcept = delete;
+
+            virtual void swap() = 0;
+    };
+
+    /**
+     * @brief Frame scoped events of one type, double buffered
+     * @details The writers push in the back buffer (an EventHandler, lock free from any thread) while the readers
+     * iterate the front buffer without any lock, as nobody writes in it during the frame. swap, called once per
+     * frame while no reader runs, publishes the back buffer as the front one. The vectors are swapped instead of
+     * copied and cleared instead of freed, so once their capacity fits the traffic a frame doesn't allocate.
+     *
+     * @tparam Event the type of event of the channel
+     */
+    template<class Event>
+    class EventChannel final : public IEventChannel
+    {
+        private:
+            EventHandler<Event> _back;
+            typename EventHandler<Event>::containerT _front;
+            typename EventHandler<Event>::containerT _late;
+            EventLifetime _lifetime;
+
+        public:
+#pragma region constructors / destructors
+            explicit EventChannel(EventLifetime aLifetime = EventLifetime::OneFrame)
+                : _lifetime(aLifetime)
+            {}
+
+            ~EventChannel() override = default;
+
+            EventChannel(const EventChannel &other) = delete;
+            EventChannel &operator=(const EventChannel &other) = delete;
+
+            EventChannel(EventChannel &&other) noexcept = delete;
+            EventChannel &operator=(EventChannel &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Push an event, readable after the next swap
+             *
+             * @param aEvent The event to push
+             */
+            void push(const Event &aEvent)
+            {
+                _back.pushEvent(aEvent);
+            }
+
+            /**
+             * @brief Get the events pushed before the last swap
+             *
+             * @return std::span<const Event> The events, valid until the next swap
+             */
+            [[nodiscard]] std::span<const Event> read() const
+            {
+                return _front;
+            }
+
+            /**
+             * @brief Get the events pushed before the swap preceding the last one
+             * @details Always empty for a channel of lifetime OneFrame
+             * @return std::span<const Event> The events, valid until the next swap
+             */
+            [[nodiscard]] std::span<const Event> readLate() const
+            {
+                return _late;
+            }
+
+            [[nodiscard]] EventLifetime getLifetime() const
+            {
+                return _lifetime;
+            }
+
+            /**
+             * @brief Publish the events pushed since the last swap, and drop the ones which lived their lifetime
+             * @details Pushes may go on meanwhile, they are published by the next swap if they miss this one
+             */
+            void swap() override
+            {
+                if (_lifetime == EventLifetime::TwoFrames) {
+                    std::swap(_late, _front);
+                }
+                _front.clear();
+                _back.swapEvents(_front);
+            }
+#pragma endregion methods
+    };
+} // namespace Engine::Event
+
+#endif /* !EVENTCHANNEL_HPP_ */
@@ -2,13 +2,39 @@
 #define EVENTHANDLER_HPP_
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <span>
+#include <utility>
 #include <vector>
+#include "EventSubscribers.hpp"
 
 namespace Engine::Event {
 
+    /**
+     * @brief How the events left are placed after a removal
+     */
+    enum class RemovalMode
+    {
+        /// the events left keep their order
+        Stable,
+        /// the last events are moved in the holes, for the readers not caring about the order
+        SwapRemove,
+    };
+
     /**
      * @brief Class that handle one type of event
+     * @details The events are pushed from any thread and read by one consumer thread. Each producer thread pushes in
+     * its own queue of segments (found through a thread local list, the handler mutex is only taken the first time a
+     * thread pushes), so a push never waits for the other threads: it copies the event in the current segment and
+     * publishes it, a new segment being linked when it is full. The consumer drains every queue into a contiguous
+     * vector, the segments it empties go back to their producer and the queues of the threads which ended are dropped
+     * once drained. The order of the events is kept per producer thread. Everything but pushEvent is for the consumer
+     * thread only. The getters never drain, so the list doesn't move under concurrent readers: the events pushed are
+     * readable once drained, by World::runSystems at the start of each frame (see EventManager::drainEvents).
      *
      * @tparam Event the type of event to handle
      */
@@ -20,9 +46,116 @@ namespace Engine::Event {
             using containerTRef = std::vector<Event> &;
             using containerTConstRef = const std::vector<Event> &;
 
+            static constexpr std::size_t segmentCapacity = 256;
+
         private:
+            struct Segment
+            {
+                    alignas(Event) std::byte storage[sizeof(Event) * segmentCapacity];
+                    /// the number of events written, published by the producer
+                    std::atomic<std::size_t> written = 0;
+                    std::atomic<Segment *> next = nullptr;
+                    /// the number of events drained, consumer only
+                    std::size_t read = 0;
+
+                    Event *slot(std::size_t aIndex)
+                    {
+                        return std::launder(reinterpret_cast<Event *>(storage + aIndex * sizeof(Event)));
+                    }
+            };
+
+            /**
+             * @brief The events of one producer thread
+             */
+            struct Queue
+            {
+                    /// producer only
+                    Segment *tail;
+                    /// consumer only
+                    Segment *head;
+                    /// an emptied segment given back by the consumer
+                    std::atomic<Segment *> spare = nullptr;
+
+                    Queue()
+                        : tail(new Segment()),
+                          head(tail)
+                    {}
+
+                    ~Queue()
+                    {
+                        for (Segment *segment = head; segment != nullptr;) {
+                            Segment *next = segment->next.load();
+
+                            for (std::size_t idx = segment->read; idx < segment->written.load(); idx++) {
+                                std::destroy_at(segment->slot(idx));
+                            }
+                            delete segment;
+                            segment = next;
+                        }
+                        delete spare.load();
+                    }
+
+                    Queue(const Queue &other) = delete;
+                    Queue &operator=(const Queue &other) = delete;
+
+                    Queue(Queue &&other) noexcept = delete;
+                    Queue &operator=(Queue &&other) noexcept = delete;
+
+                    void push(const Event &aEvent)
+                    {
+                        Segment *segment = tail;
+                        std::size_t written = segment->written.load(std::memory_order_relaxed);
+
+                        if (written == segmentCapacity) {
+                            Segment *fresh = spare.exchange(nullptr, std::memory_order_acquire);
+
+                            if (fresh == nullptr) {
+                                fresh = new Segment();
+                            }
+                            segment->next.store(fresh, std::memory_order_release);
+                            tail = fresh;
+                            segment = fresh;
+                            written = 0;
+                        }
+                        ::new (static_cast<void *>(segment->slot(written))) Event(aEvent);
+                        segment->written.store(written + 1, std::memory_order_release);
+                    }
+
+                    void drain(containerT &aEvents)
+                    {
+                        while (true) {
+                            Segment *segment = head;
+                            const std::size_t written = segment->written.load(std::memory_order_acquire);
+
+                            for (; segment->read < written; segment->read++) {
+                                aEvents.push_back(std::move(*segment->slot(segment->read)));
+                                std::destroy_at(segment->slot(segment->read));
+                            }
+                            if (segment->read < segmentCapacity) {
+                                return;
+                            }
+                            Segment *next = segment->next.load(std::memory_order_acquire);
+
+                            if (next == nullptr) {
+                                return;
+                            }
+                            // the producer linked the next segment, so it won't touch this one anymore
+                            head = next;
+                            segment->written.store(0, std::memory_order_relaxed);
+                            segment->next.store(nullptr, std::memory_order_relaxed);
+                            segment->read = 0;
+                            delete spare.exchange(segment, std::memory_order_release);
+                        }
+                    }
+            };
+
             containerT _events;
+            /// shared with the thread local lists of the producers, a queue only owned here has no producer anymore
+            std::vector<std::shared_ptr<Queue>> _queues;
             std::mutex _mutex;
+            std::size_t _id = takeId();
+            /// created by the first subscription
+            std::unique_ptr<EventSubscribers<Event>> _subscribers;
 
         public:
 #pragma region constructors / destructors
@@ -42,7 +175,10 @@ namespace Engine::Event {
             {}
 
             EventHandler(EventHandler &&aOther) noexcept
-                : _events(std::move(aOther._events))
+                : _events(std::move(aOther._events)),
+                  _queues(std::move(aOther._queues)),
+                  _id(std::exchange(aOther._id, takeId())),
+                  _subscribers(std::move(aOther._subscribers))
             {}
 
             EventHandler &operator=(const EventHandler &aOther)
@@ -60,6 +196,9 @@ namespace Engine::Event {
                     return *this;
                 }
                 _events = std::move(aOther._events);
+                _queues = std::move(aOther._queues);
+                _id = std::exchange(aOther._id, takeId());
+                _subscribers = std::move(aOther._subscribers);
                 return *this;
             }
 #pragma endregion constructors / destructors
@@ -68,19 +207,79 @@ namespace Engine::Event {
 
             /**
              * @brief Push an Event
-             * @details Can wait for the mutex to be unlocked
+             * @details Lock free, from any thread. Only the first push of a thread takes the mutex, to create the
+             * queue of the thread. The immediate subscribers are called by the pushing thread.
              * @param aEvent the new event to add to the list
              */
             void pushEvent(const Event &aEvent)
             {
-                std::lock_guard<std::mutex> lock(_mutex);
+                getQueue().push(aEvent);
+                if (_subscribers && !_subscribers->empty(DispatchMode::Immediate)) {
+                    _subscribers->call(DispatchMode::Immediate, &aEvent, 1);
+                }
+            }
 
-                _events.push_back(aEvent);
+            /**
+             * @brief Subscribe a callback to the events, see EventSubscribers
+             * @details Not while events are pushed or dispatched by another thread
+             * @param aCallback The callback, given each event
+             * @param aMode Called on each push, or on the events pushed so far by dispatch
+             * @param aPriority The callbacks of higher priority are called first
+             * @return SubscriptionHandle<Event> The handle to unsubscribe
+             */
+            SubscriptionHandle<Event> subscribe(typename EventSubscribers<Event>::callback aCallback,
+                                                DispatchMode aMode, int aPriority)
+            {
+                if (!_subscribers) {
+                    _subscribers = std::make_unique<EventSubscribers<Event>>();
+                }
+                return _subscribers->subscribe(std::move(aCallback), aMode, aPriority);
             }
 
             /**
-             * @brief Get the Events object
+             * @brief Unsubscribe a callback, in constant time
              *
+             * @param aHandle The handle given by subscribe
+             * @return true if the callback was subscribed
+             */
+            bool unsubscribe(SubscriptionHandle<Event> aHandle)
+            {
+                return _subscribers && _subscribers->unsubscribe(aHandle);
+            }
+
+            /**
+             * @brief Give every event of the list to the batched subscribers, in one loop per subscriber
+             * @details Does nothing, not even draining, without batched subscriber. The events pushed by the
+             * subscribers are only dispatched next time, and they must not remove events of this type meanwhile.
+             * The subscriptions changed by the callbacks are refreshed first, see EventSubscribers::refresh.
+             */
+            void dispatch()
+            {
+                if (_subscribers) {
+                    _subscribers->refresh();
+                }
+                if (!_subscribers || _subscribers->empty(DispatchMode::Batched)) {
+                    return;
+                }
+                drain();
+                _subscribers->call(DispatchMode::Batched, _events, _events.size());
+            }
+
+            /**
+             * @brief Move the events pushed since the last drain at the end of the list
+             * @details The list may reallocate, so nobody reads it meanwhile
+             * @return std::span<Event> The events drained, at the end of the list
+             */
+            std::span<Event> drain()
+            {
+                const std::lock_guard<std::mutex> lock(_mutex);
+
+                return drainLocked();
+            }
+
+            /**
+             * @brief Get the Events object
+             * @details Never drains, the events pushed since the last drain aren't in it
              * @return containerTRef the list of events
              */
             containerTRef getEvents()
@@ -90,7 +289,7 @@ namespace Engine::Event {
 
             /**
              * @brief Get the Events object
-             *
+             * @details Never drains, the events pushed since the last drain aren't in it
              * @return containerTConstRef the list of events
              */
             containerTConstRef getEvents() const
@@ -99,42 +298,181 @@ namespace Engine::Event {
             }
 
             /**
-             * @brief Erase all the events
-             * @details Can wait for the mutex to be unlocked
+             * @brief Erase all the events, the ones pushed since the last drain included
              */
             void clearEvents()
             {
-                std::lock_guard<std::mutex> lock(_mutex);
+                const std::lock_guard<std::mutex> lock(_mutex);
 
+                drainLocked();
                 _events.clear();
             }
 
+            /**
+             * @brief Exchange the list of events with another vector, the events pushed meanwhile drained first
+             * @details Used to recycle the capacity of the lists of a double buffer instead of copying the events
+             * @param aEvents The vector taking the events, its content becomes the list
+             */
+            void swapEvents(containerT &aEvents)
+            {
+                const std::lock_guard<std::mutex> lock(_mutex);
+
+                drainLocked();
+                _events.swap(aEvents);
+            }
+
             /**
              * @brief Remove an event from the list
-             * @details Can wait for the mutex to be unlocked
+             * @details The events pushed since the last drain aren't drained
              * @param aIdx the index of the event to remove
              */
             void removeEvent(const std::size_t aIdx)
             {
+                const std::lock_guard<std::mutex> lock(_mutex);
+
                 if (aIdx >= _events.size()) {
                     return;
                 }
-                std::lock_guard<std::mutex> lock(_mutex);
-
-                _events.erase(_events.begin() + aIdx);
+                _events.erase(_events.begin() + static_cast<std::ptrdiff_t>(aIdx));
             }
 
             void removeEvent(const Event &aEvent)
             {
-                std::lock_guard<std::mutex> lock(_mutex);
-
+                const std::lock_guard<std::mutex> lock(_mutex);
                 auto itx = std::find(_events.begin(), _events.end(), aEvent);
 
                 if (itx != _events.end()) {
                     _events.erase(itx);
                 }
             }
+
+            /**
+             * @brief Remove several events from the list at once, in one pass
+             * @details The indexes are the ones of getEvents, the events pushed since the last drain aren't drained.
+             * They may be unsorted or repeated, the ones out of the list are ignored. The removal is linear in the
+             * size of the list for Stable, in the number of indexes for SwapRemove (once sorted).
+             * @param aIndexes The indexes of the events to remove
+             * @param aMode How the events left are placed
+             */
+            void removeEvents(std::vector<std::size_t> aIndexes, RemovalMode aMode = RemovalMode::Stable)
+            {
+                const std::lock_guard<std::mutex> lock(_mutex);
+
+                if (!std::is_sorted(aIndexes.begin(), aIndexes.end())) {
+                    std::sort(aIndexes.begin(), aIndexes.end());
+                }
+                aIndexes.erase(std::unique(aIndexes.begin(), aIndexes.end()), aIndexes.end());
+                aIndexes.erase(std::lower_bound(aIndexes.begin(), aIndexes.end(), _events.size()), aIndexes.end());
+                if (aIndexes.empty()) {
+                    return;
+                }
+                if (aMode == RemovalMode::SwapRemove) {
+                    // from the last one, so the event moved in a hole is never one to remove
+                    for (auto idx = aIndexes.rbegin(); idx != aIndexes.rend(); ++idx) {
+                        if (*idx + 1 != _events.size()) {
+                            _events[*idx] = std::move(_events.back());
+                        }
+                        _events.pop_back();
+                    }
+                    return;
+                }
+                auto removed = aIndexes.begin();
+                std::size_t kept = *removed;
+
+                for (std::size_t idx = kept; idx < _events.size(); idx++) {
+                    if (removed != aIndexes.end() && *removed == idx) {
+                        ++removed;
+                        continue;
+                    }
+                    _events[kept++] = std::move(_events[idx]);
+                }
+                _events.erase(_events.begin() + static_cast<std::ptrdiff_t>(kept), _events.end());
+            }
+
+            /**
+             * @brief Remove the events matching a predicate, in one pass
+             *
+             * @tparam Predicate The type of the predicate (infered)
+             * @param aPredicate Called once per event, returns true to remove it
+             * @param aMode How the events left are placed
+             * @return std::size_t The number of events removed
+             */
+            template<typename Predicate>
+            std::size_t removeEventsIf(Predicate &&aPredicate, RemovalMode aMode = RemovalMode::Stable)
+            {
+                const std::lock_guard<std::mutex> lock(_mutex);
+                const std::size_t size = _events.size();
+
+                if (aMode == RemovalMode::Stable) {
+                    return std::erase_if(_events, std::forward<Predicate>(aPredicate));
+                }
+                for (std::size_t idx = 0; idx < _events.size();) {
+                    if (!aPredicate(std::as_const(_events[idx]))) {
+                        idx++;
+                        continue;
+                    }
+                    if (idx + 1 != _events.size()) {
+                        _events[idx] = std::move(_events.back());
+                    }
+                    _events.pop_back();
+                }
+                return size - _events.size();
+            }
 #pragma endregion methods
+
+        private:
+            /**
+             * @brief Drain every queue, the mutex held
+             */
+            std::span<Event> drainLocked()
+            {
+                const std::size_t drained = _events.size();
+
+                for (auto &queue : _queues) {
+                    const bool orphaned = queue.use_count() == 1;
+
+                    // the last pushes of an ended thread happen before it released the queue
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    queue->drain(_events);
+                    if (orphaned) {
+                        queue.reset();
+                    }
+                }
+                std::erase(_queues, nullptr);
+                return std::span<Event>(_events).subspan(drained);
+            }
+
+            /**
+             * @brief Get the queue of the calling thread, created on its first push
+             */
+            Queue &getQueue()
+            {
+                // the queues this thread already has, by handler id
+                thread_local std::vector<std::pair<std::size_t, std::shared_ptr<Queue>>> queues;
+
+                for (const auto &[handler, queue] : queues) {
+                    if (handler == _id) {
+                        return *queue;
+                    }
+                }
+                // the queues only this thread holds belong to destroyed handlers
+                std::erase_if(queues, [](const auto &aEntry) { return aEntry.second.use_count() == 1; });
+                const std::lock_guard<std::mutex> lock(_mutex);
+                const auto &queue = _queues.emplace_back(std::make_shared<Queue>());
+
+                queues.emplace_back(_id, queue);
+                return *queue;
+            }
+
+            /**
+             * @brief Get a new id for a handler, never given twice in the process
+             */
+            static std::size_t takeId()
+            {
+                static std::atomic<std::size_t> nextId = 0;
+
+                return nextId++;
+            }
     };
 } // namespace Engine::Event
-#endif /* !EVENTHANDLER_HPP_ */
\ No newline at end of file
+#endif /* !EVENTHANDLER_HPP_ */
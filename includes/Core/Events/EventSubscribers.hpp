@@ -0,0 +1,284 @@
+#ifndef EVENTSUBSCRIBERS_HPP_
+#define EVENTSUBSCRIBERS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Engine::Event {
+    /**
+     * @brief When the subscribers of an event type are called
+     */
+    enum class DispatchMode
+    {
+        /// on every push, by the pushing thread
+        Immediate,
+        /// on the events pushed so far, when the event type is dispatched
+        Batched,
+    };
+
+    /**
+     * @brief The handle of a subscription, to unsubscribe
+     * @details A handle stays invalid once unsubscribed, its slot being reused by the next subscriptions
+     */
+    template<class Event>
+    struct SubscriptionHandle
+    {
+            std::uint32_t slot;
+            std::uint32_t generation;
+    };
+
+    /**
+     * @brief The callbacks subscribed to one type of event
+     * @details The subscriptions live in slots reused once free, a handle being a slot and the generation of the
+     * slot when subscribing, so unsubscribing only checks and bumps the generation. The callbacks are called by
+     * decreasing priority, in the order they subscribed for a same priority; the order is a list of slots per mode
+     * whose unsubscribed slots are removed by refresh. Calling the callbacks never changes the order, so the pushing
+     * threads only read it. The subscriptions made by a running callback are only called once refreshed: by the next
+     * subscribe made while no callback runs, or by the next batched dispatch.
+     * Subscribing and unsubscribing is done while no event of the type is pushed or dispatched by another thread.
+     *
+     * @tparam Event the type of event
+     */
+    template<class Event>
+    class EventSubscribers final
+    {
+        public:
+            using callback = std::function<void(const Event &)>;
+
+        private:
+            static constexpr std::size_t modeCount = 2;
+            /// the value of _running while refresh changes the subscriptions
+            static constexpr std::size_t locked = std::numeric_limits<std::size_t>::max();
+
+            struct Slot
+            {
+                    callback func;
+                    int priority = 0;
+                    DispatchMode mode = DispatchMode::Immediate;
+                    std::uint32_t generation = 0;
+                    bool active = false;
+            };
+
+            /// a deque, so a callback subscribing while it runs doesn't move it
+            std::deque<Slot> _slots;
+            std::vector<std::uint32_t> _free;
+            /// the slots called by each mode, sorted by priority
+            std::array<std::vector<std::uint32_t>, modeCount> _order;
+            std::array<std::size_t, modeCount> _active {};
+            /// the slots subscribed while the callbacks run, not in the order yet
+            std::vector<std::uint32_t> _pending;
+            /// the calls running, the immediate ones may run on several pushing threads at once, or locked by refresh
+            std::atomic<std::size_t> _running = 0;
+            bool _dirty = false;
+
+        public:
+#pragma region constructors / destructors
+            EventSubscribers() = default;
+            ~EventSubscribers() = default;
+
+            EventSubscribers(const EventSubscribers &other) = delete;
+            EventSubscribers &operator=(const EventSubscribers &other) = delete;
+
+            EventSubscribers(EventSubscribers &&other) noexcept = delete;
+            EventSubscribers &operator=(EventSubscribers &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Add a callback
+             *
+             * @param aCallback The callback, given each event
+             * @param aMode When the callback is called
+             * @param aPriority The callbacks of higher priority are called first
+             * @return SubscriptionHandle<Event> The handle to unsubscribe
+             */
+            SubscriptionHandle<Event> subscribe(callback aCallback, DispatchMode aMode, int aPriority)
+            {
+                refresh();
+
+                std::uint32_t slot = 0;
+
+                if (_free.empty()) {
+                    slot = static_cast<std::uint32_t>(_slots.size());
+                    _slots.emplace_back();
+                } else {
+                    slot = _free.back();
+                    _free.pop_back();
+                }
+                auto &subscriber = _slots[slot];
+
+                subscriber.func = std::move(aCallback);
+                subscriber.priority = aPriority;
+                subscriber.mode = aMode;
+                subscriber.active = true;
+                _active[index(aMode)]++;
+                if (_running > 0) {
+                    _pending.push_back(slot);
+                    _dirty = true;
+                } else {
+                    insert(slot);
+                }
+                return {slot, subscriber.generation};
+            }
+
+            /**
+             * @brief Remove a callback, in constant time
+             * @details A callback may unsubscribe itself or another while running, it isn't called anymore afterwards.
+             * The slot is only released by the next refresh
+             * @param aHandle The handle given by subscribe
+             * @return true if the callback was subscribed
+             */
+            bool unsubscribe(SubscriptionHandle<Event> aHandle)
+            {
+                if (aHandle.slot >= _slots.size()) {
+                    return false;
+                }
+                auto &subscriber = _slots[aHandle.slot];
+
+                if (!subscriber.active || subscriber.generation != aHandle.generation) {
+                    return false;
+                }
+                subscriber.active = false;
+                subscriber.generation++;
+                _active[index(subscriber.mode)]--;
+                _dirty = true;
+                return true;
+            }
+
+            /**
+             * @brief Check if no callback is subscribed with a mode
+             *
+             * @param aMode The mode
+             * @return true if calling the callbacks of this mode does nothing
+             */
+            [[nodiscard]] bool empty(DispatchMode aMode) const
+            {
+                return _active[index(aMode)] == 0;
+            }
+
+            /**
+             * @brief Call the callbacks of a mode with some events
+             * @details Each callback is given every event before the next callback runs. The events must not be
+             * removed meanwhile. Only reads the subscriptions, from any number of threads at once.
+             * @param aMode The mode of the callbacks to call
+             * @param aEvents The events
+             * @param aCount The number of events to give, from the first
+             */
+            template<typename Events>
+            void call(DispatchMode aMode, const Events &aEvents, std::size_t aCount)
+            {
+                const Running running(*this);
+                const auto &order = _order[index(aMode)];
+                const std::size_t subscribers = order.size();
+
+                for (std::size_t idx = 0; idx < subscribers; idx++) {
+                    const Slot &subscriber = _slots[order[idx]];
+
+                    for (std::size_t event = 0; event < aCount && subscriber.active; event++) {
+                        subscriber.func(aEvents[event]);
+                    }
+                }
+            }
+
+            /**
+             * @brief Release the unsubscribed slots and order the pending ones, unless a callback runs
+             * @details The calls starting meanwhile on other threads wait for it to end
+             */
+            void refresh()
+            {
+                std::size_t idle = 0;
+
+                if (!_dirty || !_running.compare_exchange_strong(idle, locked, std::memory_order_acquire)) {
+                    return;
+                }
+                const auto release = [this](std::uint32_t aSlot) {
+                    if (_slots[aSlot].active) {
+                        return false;
+                    }
+                    _slots[aSlot].func = nullptr;
+                    _free.push_back(aSlot);
+                    return true;
+                };
+
+                for (auto &order : _order) {
+                    std::erase_if(order, release);
+                }
+                for (const auto slot : std::exchange(_pending, {})) {
+                    if (!release(slot)) {
+                        insert(slot);
+                    }
+                }
+                _dirty = false;
+                _running.store(0, std::memory_order_release);
+            }
+#pragma endregion methods
+
+        private:
+            /**
+             * @brief Counts the calls running, even when a callback throws
+             * @details Waits for a refresh running on another thread first
+             */
+            class Running
+            {
+                private:
+                    EventSubscribers &_subscribers;
+
+                public:
+                    explicit Running(EventSubscribers &aSubscribers)
+                        : _subscribers(aSubscribers)
+                    {
+                        std::size_t running = _subscribers._running.load(std::memory_order_relaxed);
+
+                        do {
+                            while (running == locked) {
+                                std::this_thread::yield();
+                                running = _subscribers._running.load(std::memory_order_relaxed);
+                            }
+                        } while (!_subscribers._running.compare_exchange_weak(running, running + 1,
+                                                                              std::memory_order_acquire));
+                    }
+
+                    ~Running()
+                    {
+                        _subscribers._running.fetch_sub(1, std::memory_order_release);
+                    }
+
+                    Running(const Running &other) = delete;
+                    Running &operator=(const Running &other) = delete;
+
+                    Running(Running &&other) noexcept = delete;
+                    Running &operator=(Running &&other) noexcept = delete;
+            };
+
+            static constexpr std::size_t index(DispatchMode aMode)
+            {
+                return static_cast<std::size_t>(aMode);
+            }
+
+            /**
+             * @brief Insert a slot in the order of its mode, after the slots of the same priority
+             */
+            void insert(std::uint32_t aSlot)
+            {
+                auto &order = _order[index(_slots[aSlot].mode)];
+                const int priority = _slots[aSlot].priority;
+                auto position = std::upper_bound(order.begin(), order.end(), priority,
+                                                 [this](int aPriority, std::uint32_t aOther) {
+                                                     return aPriority > _slots[aOther].priority;
+                                                 });
+
+                order.insert(position, aSlot);
+            }
+    };
+} // namespace Engine::Event
+
+#endif /* !EVENTSUBSCRIBERS_HPP_ */
@@ -1,37 +1,88 @@
 #ifndef EVENTMANAGER_HPP
 #define EVENTMANAGER_HPP
 
-#include <any>
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <functional>
+#include <memory>
+#include <type_traits>
 #include <typeindex>
+#include <typeinfo>
 #include <utility>
 #include <vector>
+#include "EventChannel.hpp"
 #include "EventHandler.hpp"
+#include "EventSubscribers.hpp"
 #include "Exception.hpp"
-#include <boost/container/flat_map.hpp>
 
 namespace Engine::Event {
     DEFINE_EXCEPTION(EventManagerException);
     DEFINE_EXCEPTION_FROM(EventManagerExceptionNoHandler, EventManagerException);
 
     /**
-     * @brief EventManager class is a singleton that manage all events
-     *
+     * @brief EventManager class manage the events of a World (see World::getEventManager), or of the whole process
+     * @details Each event type has a dense integer id, given by a type_index -> id map of the core library like the
+     * component ids (see ComponentRegistry), so a plugin gets the same id as the host. Each binary caches the id of a
+     * type the first time it is asked for, the handlers and the channels being indexed by it: reaching the handler of
+     * a type is a bounds check and a load. The ids are shared by every EventManager. getInstance gives a process wide
+     * EventManager, for the code which doesn't own a World.
      */
     class EventManager final
     {
-        public:
-            using func = std::function<void(EventManager &)>;
-            using eventHandler = std::pair<std::any, func>;
-
         private:
-            EventManager();
+            /**
+             * @brief Type erased handler, to clear or drain them all at once
+             */
+            class IHandler
+            {
+                public:
+                    IHandler() = default;
+                    virtual ~IHandler() = default;
+
+                    IHandler(const IHandler &other) = delete;
+                    IHandler &operator=(const IHandler &other) = delete;
+
+                    IHandler(IHandler &&other) noexcept = delete;
+                    IHandler &operator=(IHandler &&other) noexcept = delete;
+
+                    virtual void clear() = 0;
+                    virtual void drain() = 0;
+            };
+
+            template<class Event>
+            class Handler final : public IHandler
+            {
+                public:
+                    EventHandler<Event> events;
+
+                    void clear() override
+                    {
+                        events.clearEvents();
+                    }
+
+                    void drain() override
+                    {
+                        static_cast<void>(events.drain());
+                    }
+            };
 
-            boost::container::flat_map<std::type_index, eventHandler> _eventsHandler;
+            /// indexed by event id
+            std::vector<std::unique_ptr<IHandler>> _handlers;
+            /// indexed by event id
+            std::vector<std::unique_ptr<IEventChannel>> _channels;
+            /// false for the EventManager of a World, drained once per frame by World::runSystems instead
+            bool _drainOnRead;
 
         public:
-            //------------------- DESTRUCTOR-------------------//
+            //-------------------CONSTRUCTOR / DESTRUCTOR-------------------//
+            /**
+             * @brief Construct a new Event Manager object, without any handler
+             *
+             * @param aDrainOnRead If getEventsByType drains the events pushed meanwhile first, false when the owner
+             * calls drainEvents itself
+             */
+            explicit EventManager(bool aDrainOnRead = true);
+
             /**
              * @brief Destroy the Event Manager object
              *
@@ -40,21 +91,21 @@ namespace Engine::Event {
 
             //-------------------OPERATORS-------------------//
             /**
-             * @brief Copy assignment operator, delete because singleton.
+             * @brief Copy assignment operator, delete because the tasks of a World keep a reference to it.
              *
              * @param aOther The EventManager to copy.
              */
             EventManager(const EventManager &aOther) = delete;
 
             /**
-             * @brief Move assignment operator, delete because singleton.
+             * @brief Move assignment operator, delete because the tasks of a World keep a reference to it.
              *
              * @param aOther The EventManager to move.
              */
             EventManager(EventManager &&aOther) noexcept = delete;
 
             /**
-             * @brief Copy assignment operator, delete because singleton.
+             * @brief Copy assignment operator, delete because the tasks of a World keep a reference to it.
              *
              * @param aOther The EventManager to copy.
              * @return EventManager& A reference to the EventManager.
@@ -62,7 +113,7 @@ namespace Engine::Event {
             EventManager &operator=(const EventManager &aOther) = delete;
 
             /**
-             * @brief Move assignment operator, delete because singleton.
+             * @brief Move assignment operator, delete because the tasks of a World keep a reference to it.
              *
              * @param aOther The EventManager to move.
              * @return EventManager& A reference to the EventManager.
@@ -71,47 +122,70 @@ namespace Engine::Event {
 
             //-------------------METHODS-------------------//
             /**
-             * @brief Get the Instance object (singleton)
-             *
+             * @brief Get the process wide EventManager
+             * @details Its events aren't the ones of the Worlds, see World::getEventManager
              * @return EventManager A reference to the EventManager.
              */
             static EventManager &getInstance();
 
+            /**
+             * @brief Get the id of an event type
+             * @details const / reference qualifiers are ignored
+             * @tparam Event The type of the event.
+             * @return std::size_t The id, the same for every EventManager.
+             */
+            template<typename Event>
+            static std::size_t getId()
+            {
+                return typeId<std::remove_cvref_t<Event>>();
+            }
+
+            /**
+             * @brief Get the id of an event type from its type_index, given if the type has none yet
+             * @details Takes a lock, getId<Event>() only calls it once per type and binary
+             * @param aType The type of the event, without const / reference qualifiers
+             * @return std::size_t The id, the same for every EventManager.
+             */
+            static std::size_t getId(std::type_index aType);
+
             /**
              * @brief Push an event to the queue
-             * @details Doesn't call the subscribers
+             * @details Calls the immediate subscribers, the batched ones get it from dispatchEvents
              * @param aEvent The event to push.
              * @tparam Event The type of the event.
              */
             template<typename Event>
             void pushEvent(const Event &aEvent)
             {
-                try {
-                    auto &handler = getHandler<Event>();
-
-                    handler.pushEvent(aEvent);
-                } catch (const std::bad_any_cast &e) {
-                    throw EventManagerExceptionNoHandler("Can't push event");
-                }
+                getHandler<Event>().pushEvent(aEvent);
             }
 
             /**
              * @brief Get all the events of a specific type
+             * @details Drains the events of the type pushed meanwhile first, unless the EventManager belongs to a
+             * World: the events pushed since the last frame aren't in it then, so the list doesn't move under the
+             * systems
              * @tparam Event The type of the event.
              * @return std::vector<Event>& The list of events.
              */
             template<typename Event>
             std::vector<Event> &getEventsByType()
             {
-                try {
-                    auto &handler = getHandler<Event>();
+                auto &handler = getHandler<Event>();
 
-                    return handler.getEvents();
-                } catch (const std::bad_any_cast &e) {
-                    throw EventManagerExceptionNoHandler("Can't get events");
+                if (_drainOnRead) {
+                    static_cast<void>(handler.drain());
                 }
+                return handler.getEvents();
             }
 
+            /**
+             * @brief Make the events pushed since the last call readable, for every type
+             * @details Called by one thread while nobody reads the events, World::runSystems does it at the start of
+             * each frame. getEventsByType drains the type it reads by itself out of a World.
+             */
+            void drainEvents();
+
             /**
              * @brief Clear all the events of the types that aren't in the list
              * @tparam EventList The list of events to keep.
@@ -119,11 +193,11 @@ namespace Engine::Event {
             template<typename... EventList>
             void keepEventsAndClear()
             {
-                std::vector<std::type_index> eventIndexList = {std::type_index(typeid(EventList))...};
+                const std::array<std::size_t, sizeof...(EventList)> kept = {getId<EventList>()...};
 
-                for (auto &lbd : _eventsHandler) {
-                    if (std::find(eventIndexList.begin(), eventIndexList.end(), lbd.first) == eventIndexList.end()) {
-                        lbd.second.second(*this);
+                for (std::size_t id = 0; id < _handlers.size(); id++) {
+                    if (_handlers[id] && std::find(kept.begin(), kept.end(), id) == kept.end()) {
+                        _handlers[id]->clear();
                     }
                 }
             }
@@ -137,60 +211,50 @@ namespace Engine::Event {
             template<typename Event>
             void removeEvent(const std::size_t aIndex)
             {
-                auto eventIndex = std::type_index(typeid(Event));
-
-                if (_eventsHandler.find(eventIndex) == _eventsHandler.end()) {
-                    return;
-                }
-                try {
-                    auto &handler = getHandler<Event>();
-
-                    handler.removeEvent(aIndex);
-                } catch (const std::bad_any_cast &e) {
-                    throw EventManagerExceptionNoHandler("Can't remove event");
+                if (auto *handler = findHandler<Event>()) {
+                    handler->removeEvent(aIndex);
                 }
             }
 
             /**
-             * @brief Remove an event from the queue
-             * @param aIndexes The indexes of the event to remove.
+             * @brief Remove events from the queue in one pass, see EventHandler::removeEvents
+             * @param aIndexes The indexes of the event to remove, in any order.
+             * @param aMode How the events left are placed.
              * @tparam Event The type of the event.
              *
              */
             template<typename Event>
-            void removeEvent(std::vector<size_t> aIndexes)
+            void removeEvent(std::vector<size_t> aIndexes, RemovalMode aMode = RemovalMode::Stable)
             {
-                auto eventIndex = std::type_index(typeid(Event));
-
-                if (_eventsHandler.find(eventIndex) == _eventsHandler.end()) {
-                    return;
+                if (auto *handler = findHandler<Event>()) {
+                    handler->removeEvents(std::move(aIndexes), aMode);
                 }
-                try {
-                    auto &handler = getHandler<Event>();
+            }
 
-                    for (size_t i = 0; i < aIndexes.size(); i++) {
-                        size_t idx = aIndexes[i] - i;
+            /**
+             * @brief Remove the events matching a predicate in one pass
+             * @param aPredicate Called once per event, returns true to remove it.
+             * @param aMode How the events left are placed.
+             * @tparam Event The type of the event.
+             * @tparam Predicate The type of the predicate (infered).
+             * @return std::size_t The number of events removed.
+             */
+            template<typename Event, typename Predicate>
+            std::size_t removeEventsIf(Predicate &&aPredicate, RemovalMode aMode = RemovalMode::Stable)
+            {
+                auto *handler = findHandler<Event>();
 
-                        handler.removeEvent(idx);
-                    }
-                } catch (const std::bad_any_cast &e) {
-                    throw EventManagerExceptionNoHandler("Can't remove event");
-                }
+                return handler != nullptr ? handler->removeEventsIf(std::forward<Predicate>(aPredicate), aMode) : 0;
             }
 
             template<typename Event>
             void initEventHandler()
             {
-                auto eventTypeIndex = std::type_index(typeid(Event));
+                auto &handler = slot(_handlers, getId<Event>());
 
-                if (_eventsHandler.find(eventTypeIndex) != _eventsHandler.end()) {
-                    return;
+                if (!handler) {
+                    handler = std::make_unique<Handler<Event>>();
                 }
-                _eventsHandler[eventTypeIndex] = std::make_pair(EventHandler<Event>(), [](EventManager &aEventManager) {
-                    auto &handler = aEventManager.getHandler<Event>();
-
-                    handler.clearEvents();
-                });
             }
 
             template<typename... EventList>
@@ -199,29 +263,138 @@ namespace Engine::Event {
                 (initEventHandler<EventList>(), ...);
             }
 
+            /**
+             * @brief Subscribe a callback to an event type, see EventSubscribers
+             * @details Not while events of the type are pushed or dispatched by another thread
+             * @param aCallback The callback, given each event
+             * @param aMode Called on each push, or on the events pushed so far by dispatchEvents
+             * @param aPriority The callbacks of higher priority are called first
+             * @tparam Event The type of the event.
+             * @return SubscriptionHandle<Event> The handle to unsubscribe
+             */
+            template<typename Event>
+            SubscriptionHandle<Event> subscribe(typename EventSubscribers<Event>::callback aCallback,
+                                                DispatchMode aMode = DispatchMode::Immediate, int aPriority = 0)
+            {
+                return getHandler<Event>().subscribe(std::move(aCallback), aMode, aPriority);
+            }
+
+            /**
+             * @brief Unsubscribe a callback from an event type, in constant time
+             * @param aHandle The handle given by subscribe
+             * @tparam Event The type of the event.
+             * @return true if the callback was subscribed
+             */
+            template<typename Event>
+            bool unsubscribe(SubscriptionHandle<Event> aHandle)
+            {
+                return getHandler<Event>().unsubscribe(aHandle);
+            }
+
+            /**
+             * @brief Give the events of some types to their batched subscribers
+             * @details The events stay in the queue, clear them once every reader is done. The types without batched
+             * subscriber are skipped.
+             * @tparam EventList The types of the events to dispatch, in this order.
+             */
+            template<typename... EventList>
+            void dispatchEvents()
+            {
+                (getHandler<EventList>().dispatch(), ...);
+            }
+
+            /**
+             * @brief Create the channel of an event type, see EventChannel
+             * @details Does nothing if the channel exists
+             * @param aLifetime How many swaps the events stay readable
+             * @tparam Event The type of the event.
+             */
+            template<typename Event>
+            void initEventChannel(EventLifetime aLifetime = EventLifetime::OneFrame)
+            {
+                auto &channel = slot(_channels, getId<Event>());
+
+                if (!channel) {
+                    channel = std::make_unique<EventChannel<Event>>(aLifetime);
+                }
+            }
+
+            /**
+             * @brief Get the channel of an event type
+             * @throw EventManagerExceptionNoHandler if initEventChannel wasn't called for this type
+             * @tparam Event The type of the event.
+             * @return EventChannel<Event>& The channel, to push to and read from
+             */
+            template<typename Event>
+            EventChannel<Event> &getChannel()
+            {
+                const std::size_t id = getId<Event>();
+
+                if (id >= _channels.size() || !_channels[id]) {
+                    throw EventManagerExceptionNoHandler("There is no channel of this type");
+                }
+                return static_cast<EventChannel<Event> &>(*_channels[id]);
+            }
+
+            /**
+             * @brief Swap the buffers of every channel, once per frame while no reader runs
+             */
+            void swapChannels();
+
         private:
+            /**
+             * @brief Get the handler of an event type, if initEventHandler was called for it
+             *
+             * @tparam Event The type of the event to get the handler
+             * @return EventHandler<Event>* The handler of the event, or nullptr.
+             */
+            template<typename Event>
+            EventHandler<Event> *findHandler()
+            {
+                const std::size_t id = getId<Event>();
+
+                if (id >= _handlers.size() || !_handlers[id]) {
+                    return nullptr;
+                }
+                return &static_cast<Handler<Event> &>(*_handlers[id]).events;
+            }
+
             /**
              * @brief Get an Hander linked to an event
              *
+             * @throw EventManagerExceptionNoHandler if initEventHandler wasn't called for this type
              * @tparam Event The type of the event to get the handler
              * @return EventHandler<Event>& The handler of the event.
              */
             template<typename Event>
             EventHandler<Event> &getHandler()
             {
-                auto eventTypeIndex = std::type_index(typeid(Event));
+                auto *handler = findHandler<Event>();
 
-                try {
-                    if (_eventsHandler.find(eventTypeIndex) == _eventsHandler.cend()) {
-                        throw EventManagerExceptionNoHandler("There is no handler of this type");
-                    }
-                    auto &handler = _eventsHandler.at(eventTypeIndex);
-                    auto &component = std::any_cast<EventHandler<Event> &>(handler);
-
-                    return component;
-                } catch (const std::bad_any_cast &e) {
+                if (handler == nullptr) {
                     throw EventManagerExceptionNoHandler("There is no handler of this type");
                 }
+                return *handler;
+            }
+
+            /**
+             * @brief Get the slot of an id in a table indexed by event id, grown if needed
+             */
+            template<typename Table>
+            static typename Table::value_type &slot(Table &aTable, std::size_t aId)
+            {
+                if (aId >= aTable.size()) {
+                    aTable.resize(aId + 1);
+                }
+                return aTable[aId];
+            }
+
+            template<typename Event>
+            static std::size_t typeId()
+            {
+                static const std::size_t id = getId(std::type_index(typeid(Event)));
+
+                return id;
             }
     };
 } // namespace Engine::Event
@@ -0,0 +1,74 @@
+#ifndef FIXEDTIMESTEP_HPP_
+#define FIXEDTIMESTEP_HPP_
+
+#include <cstddef>
+#include "Exception.hpp"
+
+namespace Engine::Core {
+    DEFINE_EXCEPTION(FixedTimestepException);
+
+    /**
+     * @brief Accumulator turning the variable time of the frames into a number of fixed steps
+     * @details The times are in milliseconds, like Clock. A frame too long for aMaxSteps steps drops the steps it
+     * can't catch up on, so a slow frame can't make the next ones slower. A timestep built without a rate is variable:
+     * each frame is one step of the frame time.
+     */
+    class FixedTimestep final
+    {
+        public:
+            static constexpr std::size_t defaultMaxSteps = 5;
+
+        private:
+            double _step = 0;
+            std::size_t _maxSteps = defaultMaxSteps;
+            double _accumulator = 0;
+
+        public:
+#pragma region constructors / destructors
+            FixedTimestep() = default;
+
+            /**
+             * @brief Construct a new Fixed Timestep object
+             * @throw FixedTimestepException if the rate is negative or the max steps 0
+             * @param aHertz The number of steps per second, 0 for a variable timestep
+             * @param aMaxSteps The max number of steps run in one frame
+             */
+            explicit FixedTimestep(double aHertz, std::size_t aMaxSteps = defaultMaxSteps);
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Add the time of a frame
+             *
+             * @param aElapsed The time of the frame in milliseconds
+             * @return std::size_t The number of steps to run this frame, always 1 for a variable timestep
+             */
+            std::size_t advance(double aElapsed);
+
+            /**
+             * @brief Get how far the time is between the last step and the next one
+             *
+             * @return double The time left in the accumulator over the step, in [0, 1), 0 for a variable timestep
+             */
+            [[nodiscard]] double getAlpha() const;
+
+            /**
+             * @brief Get the time of one step
+             *
+             * @return double The step in milliseconds, 0 for a variable timestep
+             */
+            [[nodiscard]] double getStep() const;
+
+            [[nodiscard]] std::size_t getMaxSteps() const;
+
+            [[nodiscard]] bool isFixed() const;
+
+            /**
+             * @brief Drop the time accumulated
+             */
+            void reset();
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !FIXEDTIMESTEP_HPP_ */
@@ -0,0 +1,188 @@
+#ifndef JOBSYSTEM_HPP_
+#define JOBSYSTEM_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include "Exception.hpp"
+
+namespace Engine::Core {
+    DEFINE_EXCEPTION(JobSystemException);
+    DEFINE_EXCEPTION_FROM(JobSystemExceptionAlreadyStarted, JobSystemException);
+
+    /**
+     * @brief Handle on a spawned job, to wait for it or to start other jobs after it
+     * @details A default constructed handle refers to no job and counts as done
+     */
+    class JobHandle final
+    {
+            friend class JobSystem;
+
+        public:
+            struct State;
+
+        private:
+            std::shared_ptr<State> _state;
+
+        public:
+#pragma region constructors / destructors
+            JobHandle() = default;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Check if the job ran (or was skipped because a job it waited for failed)
+             *
+             * @return true if the job is over
+             */
+            [[nodiscard]] bool isDone() const;
+#pragma endregion methods
+
+        private:
+            explicit JobHandle(std::shared_ptr<State> aState);
+    };
+
+    /**
+     * @brief Work-stealing job system: the threads the engine runs its parallel work on
+     * @details Each worker owns a deque: the jobs it spawns are pushed at the back and it pops from the back, the idle
+     * workers steal from the front of the others. The jobs spawned from other threads go through a shared injection
+     * queue. A thread waiting for a job runs the queued jobs meanwhile, so a job can spawn and wait for other jobs
+     * without deadlocking, even without worker.
+     */
+    class JobSystem final
+    {
+        public:
+            using job = std::function<void()>;
+            using rangeFunc = std::function<void(std::size_t aBegin, std::size_t aEnd)>;
+
+            static constexpr std::size_t defaultGrain = 1024;
+
+        private:
+            struct Queue
+            {
+                    std::mutex mutex;
+                    std::deque<std::shared_ptr<JobHandle::State>> jobs;
+            };
+
+            /// one queue per worker, then the injection queue
+            std::vector<std::unique_ptr<Queue>> _queues;
+            std::vector<std::thread> _workers;
+            std::atomic<std::size_t> _queued = 0;
+            std::mutex _sleepMutex;
+            std::condition_variable _wake;
+            bool _stopping = false;
+            bool _pinned;
+
+        public:
+#pragma region constructors / destructors
+            /**
+             * @brief Construct a new Job System object
+             *
+             * @param aWorkerCount The number of threads started, the waiting threads come on top of them
+             * @param aPinThreads Pin each worker to its own core (only on Linux, ignored elsewhere)
+             */
+            explicit JobSystem(std::size_t aWorkerCount = getDefaultWorkerCount(), bool aPinThreads = false);
+            ~JobSystem();
+
+            JobSystem(const JobSystem &other) = delete;
+            JobSystem &operator=(const JobSystem &other) = delete;
+
+            JobSystem(JobSystem &&other) noexcept = delete;
+            JobSystem &operator=(JobSystem &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Queue a job
+             *
+             * @param aJob The function to run
+             * @return JobHandle The handle of the job
+             */
+            JobHandle spawn(job aJob);
+
+            /**
+             * @brief Queue a job once other jobs are done
+             * @details If one of the jobs waited for failed, aJob is skipped and its handle carries the same exception
+             * @param aParents The jobs to wait for
+             * @param aJob The function to run
+             * @return JobHandle The handle of the continuation
+             */
+            JobHandle spawnAfter(std::span<const JobHandle> aParents, job aJob);
+
+            /**
+             * @brief Queue a job once another one is done, see spawnAfter(std::span<const JobHandle>, job)
+             */
+            JobHandle spawnAfter(const JobHandle &aParent, job aJob);
+
+            /**
+             * @brief Run queued jobs until a job is done
+             * @details Blocks only when there is nothing left to run
+             * @param aHandle The job to wait for
+             * @throw The exception thrown by the job, if any
+             */
+            void wait(const JobHandle &aHandle);
+
+            /**
+             * @brief Split [0, aCount) in ranges of aGrain indexes and run them on the workers and the calling thread
+             * @details Each index is given to exactly one call of aFunc. Returns once every range is done, the first
+             * exception thrown by aFunc is rethrown in the calling thread.
+             * @param aCount The number of indexes
+             * @param aGrain The number of indexes of a range, 0 is taken as 1
+             * @param aFunc The function to call with each range
+             */
+            void parallelFor(std::size_t aCount, std::size_t aGrain, const rangeFunc &aFunc);
+
+            /**
+             * @brief Get the number of worker threads
+             *
+             * @return std::size_t The number of workers, without the waiting threads
+             */
+            [[nodiscard]] std::size_t getWorkerCount() const;
+
+            /**
+             * @brief Check if the workers are pinned to their cores
+             *
+             * @return true if pinning was asked and is supported
+             */
+            [[nodiscard]] bool isPinned() const;
+
+            /**
+             * @brief Get the job system shared by the whole engine
+             *
+             * @return JobSystem& The job system, started on first use as set by configureShared
+             */
+            static JobSystem &getShared();
+
+            /**
+             * @brief Set how the shared job system is started
+             * @throw JobSystemExceptionAlreadyStarted if getShared was already called
+             * @param aWorkerCount The number of workers
+             * @param aPinThreads Pin each worker to its own core
+             */
+            static void configureShared(std::size_t aWorkerCount, bool aPinThreads = false);
+
+            /**
+             * @brief Get the number of workers of a job system using every core
+             *
+             * @return std::size_t The number of hardware threads minus the calling one
+             */
+            static std::size_t getDefaultWorkerCount();
+
+        private:
+            void schedule(std::shared_ptr<JobHandle::State> aState);
+            [[nodiscard]] std::shared_ptr<JobHandle::State> take(std::size_t aQueue);
+            bool runOne(std::size_t aQueue);
+            void execute(const std::shared_ptr<JobHandle::State> &aState);
+            void workerLoop(std::size_t aIndex);
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !JOBSYSTEM_HPP_ */
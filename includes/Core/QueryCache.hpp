@@ -0,0 +1,114 @@
+#ifndef QUERYCACHE_HPP_
+#define QUERYCACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "Signature.hpp"
+
+namespace Engine::Core {
+    /**
+     * @brief Type erased part of a query registered in a World: the list of the matching entities
+     * @details The World calls refresh with the new signature of an entity each time it gains or loses one of the
+     * components of the query, and remove when an entity is killed, so the list is always up to date without
+     * scanning the entities each frame.
+     * The entities are kept in a dense array with a sparse entity -> position index, removal is a swap-remove.
+     */
+    class QueryCache
+    {
+        public:
+            using id = std::size_t;
+            using position = std::uint32_t;
+
+            static constexpr position npos = std::numeric_limits<position>::max();
+
+        protected:
+            std::vector<id> _entities;
+            std::vector<position> _positions;
+            Signature _mask;
+            Signature _exclude;
+
+        public:
+#pragma region constructors / destructors
+            /**
+             * @brief Construct a new Query Cache object
+             *
+             * @param aMask The ids of the components an entity needs to belong to the query
+             * @param aExclude The ids of the components an entity must not own to belong to the query
+             */
+            explicit QueryCache(const Signature &aMask, const Signature &aExclude = Signature());
+            virtual ~QueryCache() = default;
+
+            QueryCache(const QueryCache &other) = delete;
+            QueryCache &operator=(const QueryCache &other) = delete;
+
+            QueryCache(QueryCache &&other) noexcept = delete;
+            QueryCache &operator=(QueryCache &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Add or remove an entity according to its current components
+             *
+             * @param aEntity The index of the entity
+             * @param aSignature The components the entity owns
+             */
+            void refresh(id aEntity, const Signature &aSignature);
+
+            /**
+             * @brief Remove an entity if it is in the list
+             *
+             * @param aEntity The index of the entity
+             */
+            void remove(id aEntity);
+
+            /**
+             * @brief Empty the list
+             */
+            void clear();
+
+            /**
+             * @brief Check if an entity is in the list
+             *
+             * @param aEntity The index of the entity
+             * @return true if the entity matches the query
+             */
+            [[nodiscard]] bool contains(id aEntity) const;
+
+            /**
+             * @brief Get the matching entities
+             *
+             * @return std::span<const id> The indexes of the entities, in no particular order
+             */
+            [[nodiscard]] std::span<const id> getEntities() const;
+
+            /**
+             * @brief Get the number of matching entities
+             *
+             * @return std::size_t The number of entities
+             */
+            [[nodiscard]] std::size_t size() const;
+
+            /**
+             * @brief Get the components the query depends on
+             *
+             * @return const Signature& One bit per ComponentRegistry id
+             */
+            [[nodiscard]] const Signature &getMask() const;
+
+            /**
+             * @brief Get the components excluded from the query
+             *
+             * @return const Signature& One bit per ComponentRegistry id
+             */
+            [[nodiscard]] const Signature &getExcludeMask() const;
+
+        protected:
+            void insert(id aEntity);
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !QUERYCACHE_HPP_ */
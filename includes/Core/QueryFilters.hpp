@@ -0,0 +1,328 @@
+#ifndef QUERYFILTERS_HPP_
+#define QUERYFILTERS_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Archetype.hpp"
+#include "ChangeTicks.hpp"
+#include "Signature.hpp"
+#include "SparseArray.hpp"
+
+namespace Engine::Core {
+    class World;
+
+    /**
+     * @brief Query term requiring a component without giving it to the callback
+     */
+    template<typename Component>
+    struct With final
+    {};
+
+    /**
+     * @brief Query term excluding the entities owning a component
+     */
+    template<typename Component>
+    struct Without final
+    {};
+
+    /**
+     * @brief Query term giving a component to the callback as a pointer, nullptr if the entity doesn't own it
+     */
+    template<typename Component>
+    struct Optional final
+    {};
+
+    /**
+     * @brief Query term matching the entities which got a component since the last run of the system
+     */
+    template<typename Component>
+    struct Added final
+    {};
+
+    /**
+     * @brief Query term matching the entities whose component was added or mutably accessed since the last run of the
+     * system
+     */
+    template<typename Component>
+    struct Changed final
+    {};
+
+    /**
+     * @brief Query term giving the component as it was at the end of the previous frame, as a const reference
+     * @details Reads the snapshot of the component (see World::enableSnapshot), so it doesn't count as a read of the
+     * component: the systems reading snapshots run alongside the ones writing the component. The entities which got
+     * the component this frame have no snapshot yet and are skipped.
+     */
+    template<typename Component>
+    struct Snapshot final
+    {};
+
+    /**
+     * @brief The masks a query is matched against: every bit of include set, no bit of exclude set
+     */
+    struct QueryMasks final
+    {
+            Signature include;
+            Signature exclude;
+    };
+
+    /**
+     * @brief The components a query reads and the ones it writes
+     */
+    struct QueryAccess final
+    {
+            Signature reads;
+            Signature writes;
+    };
+
+    /**
+     * @brief How a term of a query is matched and what it gives to the callback
+     * @details A plain component is required and given as a reference. fetch reads the component of an entity from
+     * a SparseArray or from the row of an archetype column, and returns what the term adds to the callback arguments.
+     * A const component is given as a const reference and only counts as read. accepts checks the change ticks of a
+     * matching entity (SparseArrays only, tracked is true for the terms needing it) and touch marks the components
+     * given as mutable as changed. The terms with snapshot set are fetched from the snapshot of the component instead
+     * of its SparseArray.
+     *
+     * @tparam Term The component, or one of With / Without / Optional / Added / Changed
+     */
+    template<typename Term>
+    struct QueryTerm
+    {
+            using component = std::remove_const_t<Term>;
+
+            static constexpr bool required = true;
+            static constexpr bool excluded = false;
+            static constexpr bool accessed = true;
+            static constexpr bool readOnly = std::is_const_v<Term>;
+            static constexpr bool tracked = false;
+            static constexpr bool snapshot = false;
+
+            static bool accepts(SparseArray<component> & /*unused*/, std::size_t /*unused*/,
+                                const ChangeTicks & /*unused*/)
+            {
+                return true;
+            }
+
+            static void touch(SparseArray<component> &aPool, std::size_t aIndex, tick aTick)
+            {
+                if constexpr (!readOnly) {
+                    aPool.markChanged(aIndex, aTick);
+                }
+            }
+
+            static std::tuple<Term &> fetch(SparseArray<component> &aPool, std::size_t aIndex)
+            {
+                return {aPool.getUnchecked(aIndex)};
+            }
+
+            static std::tuple<Term &> fetch(component *aColumn, std::size_t aRow)
+            {
+                return {aColumn[aRow]};
+            }
+
+            static component *column(Archetype &aArchetype, std::size_t aChunk, std::size_t aBit)
+            {
+                return aArchetype.getColumn<component>(aChunk, aBit);
+            }
+    };
+
+    /**
+     * @brief Terms matched on the signature only, nothing is given to the callback
+     */
+    template<typename Component, bool Required>
+    struct QueryFilterTerm
+    {
+            using component = std::remove_const_t<Component>;
+
+            static constexpr bool required = Required;
+            static constexpr bool excluded = !Required;
+            static constexpr bool accessed = false;
+            static constexpr bool readOnly = true;
+            static constexpr bool tracked = false;
+            static constexpr bool snapshot = false;
+
+            static bool accepts(SparseArray<component> & /*unused*/, std::size_t /*unused*/,
+                                const ChangeTicks & /*unused*/)
+            {
+                return true;
+            }
+
+            static void touch(SparseArray<component> & /*unused*/, std::size_t /*unused*/, tick /*unused*/)
+            {}
+
+            static std::tuple<> fetch(SparseArray<component> & /*unused*/, std::size_t /*unused*/)
+            {
+                return {};
+            }
+
+            static std::tuple<> fetch(component * /*unused*/, std::size_t /*unused*/)
+            {
+                return {};
+            }
+
+            static component *column(Archetype & /*unused*/, std::size_t /*unused*/, std::size_t /*unused*/)
+            {
+                return nullptr;
+            }
+    };
+
+    template<typename Component>
+    struct QueryTerm<With<Component>> : QueryFilterTerm<Component, true>
+    {};
+
+    template<typename Component>
+    struct QueryTerm<Without<Component>> : QueryFilterTerm<Component, false>
+    {};
+
+    template<typename Component>
+    struct QueryTerm<Optional<Component>>
+    {
+            using component = std::remove_const_t<Component>;
+
+            static constexpr bool required = false;
+            static constexpr bool excluded = false;
+            static constexpr bool accessed = true;
+            static constexpr bool readOnly = std::is_const_v<Component>;
+            static constexpr bool tracked = false;
+            static constexpr bool snapshot = false;
+
+            static bool accepts(SparseArray<component> & /*unused*/, std::size_t /*unused*/,
+                                const ChangeTicks & /*unused*/)
+            {
+                return true;
+            }
+
+            static void touch(SparseArray<component> &aPool, std::size_t aIndex, tick aTick)
+            {
+                if constexpr (!readOnly) {
+                    if (aPool.contains(aIndex)) {
+                        aPool.markChanged(aIndex, aTick);
+                    }
+                }
+            }
+
+            static std::tuple<Component *> fetch(SparseArray<component> &aPool, std::size_t aIndex)
+            {
+                return {aPool.contains(aIndex) ? &aPool.getUnchecked(aIndex) : nullptr};
+            }
+
+            static std::tuple<Component *> fetch(component *aColumn, std::size_t aRow)
+            {
+                return {aColumn != nullptr ? aColumn + aRow : nullptr};
+            }
+
+            static component *column(Archetype &aArchetype, std::size_t aChunk, std::size_t aBit)
+            {
+                if (!aArchetype.getSignature().test(aBit)) {
+                    return nullptr;
+                }
+                return aArchetype.getColumn<component>(aChunk, aBit);
+            }
+    };
+
+    /**
+     * @brief Terms matched on the change ticks of a required component, nothing is given to the callback
+     * @details The ticks are read, so the term counts as a read of the component
+     */
+    template<typename Component, bool OnlyAdded>
+    struct QueryChangeTerm
+    {
+            using component = std::remove_const_t<Component>;
+
+            static constexpr bool required = true;
+            static constexpr bool excluded = false;
+            static constexpr bool accessed = true;
+            static constexpr bool readOnly = true;
+            static constexpr bool tracked = true;
+            static constexpr bool snapshot = false;
+
+            static bool accepts(SparseArray<component> &aPool, std::size_t aIndex, const ChangeTicks &aTicks)
+            {
+                return aTicks.isNewer(OnlyAdded ? aPool.getAddedTick(aIndex) : aPool.getChangedTick(aIndex));
+            }
+
+            static void touch(SparseArray<component> & /*unused*/, std::size_t /*unused*/, tick /*unused*/)
+            {}
+
+            static std::tuple<> fetch(SparseArray<component> & /*unused*/, std::size_t /*unused*/)
+            {
+                return {};
+            }
+
+            static std::tuple<> fetch(component * /*unused*/, std::size_t /*unused*/)
+            {
+                return {};
+            }
+
+            static component *column(Archetype & /*unused*/, std::size_t /*unused*/, std::size_t /*unused*/)
+            {
+                return nullptr;
+            }
+    };
+
+    template<typename Component>
+    struct QueryTerm<Added<Component>> : QueryChangeTerm<Component, true>
+    {};
+
+    template<typename Component>
+    struct QueryTerm<Changed<Component>> : QueryChangeTerm<Component, false>
+    {};
+
+    template<typename Component>
+    struct QueryTerm<Snapshot<Component>>
+    {
+            using component = std::remove_const_t<Component>;
+
+            static constexpr bool required = true;
+            static constexpr bool excluded = false;
+            static constexpr bool accessed = false;
+            static constexpr bool readOnly = true;
+            static constexpr bool tracked = false;
+            static constexpr bool snapshot = true;
+
+            static bool accepts(SparseArray<component> &aPool, std::size_t aIndex, const ChangeTicks & /*unused*/)
+            {
+                return aPool.contains(aIndex);
+            }
+
+            static void touch(SparseArray<component> & /*unused*/, std::size_t /*unused*/, tick /*unused*/)
+            {}
+
+            static std::tuple<const component &> fetch(SparseArray<component> &aPool, std::size_t aIndex)
+            {
+                return {aPool.getUnchecked(aIndex)};
+            }
+
+            static std::tuple<const component &> fetch(component *aColumn, std::size_t aRow)
+            {
+                return {aColumn[aRow]};
+            }
+
+            static component *column(Archetype & /*unused*/, std::size_t /*unused*/, std::size_t /*unused*/)
+            {
+                return nullptr;
+            }
+    };
+
+    /**
+     * @brief The std::function type matching the callback of a query
+     */
+    template<typename Tuple>
+    struct QueryFunction;
+
+    template<typename... Args>
+    struct QueryFunction<std::tuple<Args...>>
+    {
+            using type = std::function<void(World &world, double deltaTime, std::size_t idx, Args...)>;
+    };
+
+    template<typename... Terms>
+    using queryFunction = typename QueryFunction<decltype(std::tuple_cat(
+        QueryTerm<Terms>::fetch(std::declval<SparseArray<typename QueryTerm<Terms>::component> &>(), 0)...))>::type;
+} // namespace Engine::Core
+
+#endif /* !QUERYFILTERS_HPP_ */
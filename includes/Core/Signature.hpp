@@ -0,0 +1,212 @@
+#ifndef SIGNATURE_HPP_
+#define SIGNATURE_HPP_
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#ifndef ZEPHYR_MAX_COMPONENTS
+    #define ZEPHYR_MAX_COMPONENTS 128
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define ZEPHYR_SIGNATURE_SSE2
+#endif
+
+namespace Engine::Core {
+    /**
+     * @brief Fixed size bitset describing a set of component types, one bit per component id
+     * @details The capacity is set at compile time with ZEPHYR_MAX_COMPONENTS (128 by default)
+     */
+    class Signature final
+    {
+        public:
+            using word = std::uint64_t;
+
+            static constexpr std::size_t bitsPerWord = 64;
+            static constexpr std::size_t capacity = ZEPHYR_MAX_COMPONENTS;
+            static constexpr std::size_t wordCount = (capacity + bitsPerWord - 1) / bitsPerWord;
+
+        private:
+            std::array<word, wordCount> _words {};
+
+        public:
+#pragma region constructors / destructors
+            Signature() = default;
+            ~Signature() = default;
+
+            Signature(const Signature &other) = default;
+            Signature &operator=(const Signature &other) = default;
+
+            Signature(Signature &&other) noexcept = default;
+            Signature &operator=(Signature &&other) noexcept = default;
+#pragma endregion constructors / destructors
+
+#pragma region operators
+            auto operator<=>(const Signature &other) const = default;
+            bool operator==(const Signature &other) const = default;
+#pragma endregion operators
+
+#pragma region methods
+            /**
+             * @brief Set a bit
+             *
+             * @param aBit The bit to set, must be lower than capacity
+             */
+            void set(std::size_t aBit)
+            {
+                _words[aBit / bitsPerWord] |= word {1} << (aBit % bitsPerWord);
+            }
+
+            /**
+             * @brief Clear a bit
+             *
+             * @param aBit The bit to clear, must be lower than capacity
+             */
+            void reset(std::size_t aBit)
+            {
+                _words[aBit / bitsPerWord] &= ~(word {1} << (aBit % bitsPerWord));
+            }
+
+            /**
+             * @brief Check a bit
+             *
+             * @param aBit The bit to check, must be lower than capacity
+             * @return true if the bit is set
+             */
+            [[nodiscard]] bool test(std::size_t aBit) const
+            {
+                return (_words[aBit / bitsPerWord] & (word {1} << (aBit % bitsPerWord))) != 0;
+            }
+
+            /**
+             * @brief Check if every bit of aOther is also set in this signature
+             *
+             * @param aOther The required bits
+             * @return true if this signature is a superset of aOther
+             */
+            [[nodiscard]] bool contains(const Signature &aOther) const
+            {
+                for (std::size_t idx = 0; idx < wordCount; idx++) {
+                    if ((_words[idx] & aOther._words[idx]) != aOther._words[idx]) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * @brief Check if at least one bit is set in both signatures
+             *
+             * @param aOther The signature to compare with
+             * @return true if the signatures share a bit
+             */
+            [[nodiscard]] bool intersects(const Signature &aOther) const
+            {
+                for (std::size_t idx = 0; idx < wordCount; idx++) {
+                    if ((_words[idx] & aOther._words[idx]) != 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * @brief Check if no bit is set
+             *
+             * @return true if the signature is empty
+             */
+            [[nodiscard]] bool none() const
+            {
+                for (const auto &bits : _words) {
+                    if (bits != 0) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * @brief Call a function with each set bit, in ascending order
+             *
+             * @param aFunc The function to call with the bit index
+             */
+            template<typename Func>
+            void forEach(Func &&aFunc) const
+            {
+                for (std::size_t idx = 0; idx < wordCount; idx++) {
+                    for (word bits = _words[idx]; bits != 0; bits &= bits - 1) {
+                        aFunc(idx * bitsPerWord + static_cast<std::size_t>(std::countr_zero(bits)));
+                    }
+                }
+            }
+
+            /**
+             * @brief Build a signature from a list of bits
+             *
+             * @param aBits The bits to set
+             * @return Signature The signature
+             */
+            template<typename... Bits>
+            static Signature from(Bits... aBits)
+            {
+                Signature signature;
+
+                (signature.set(static_cast<std::size_t>(aBits)), ...);
+                return signature;
+            }
+
+            /**
+             * @brief Append the position of each signature containing a mask
+             * @details With SSE2 each signature is compared 128 bits at a time, the mask being loaded once
+             *
+             * @param aSignatures The signatures to filter, usually one per entity
+             * @param aMask The required bits
+             * @param aOut The vector receiving the positions of the matching signatures, in ascending order
+             */
+            static void filter(std::span<const Signature> aSignatures, const Signature &aMask,
+                               std::vector<std::size_t> &aOut)
+            {
+#ifdef ZEPHYR_SIGNATURE_SSE2
+                if constexpr (wordCount % 2 == 0) {
+                    constexpr std::size_t laneCount = wordCount / 2;
+                    constexpr int allEqual = 0xFFFF;
+                    __m128i mask[laneCount]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+
+                    for (std::size_t lane = 0; lane < laneCount; lane++) {
+                        mask[lane] = _mm_loadu_si128(
+                            reinterpret_cast<const __m128i *>(&aMask._words[lane * 2])); // NOLINT
+                    }
+                    for (std::size_t idx = 0; idx < aSignatures.size(); idx++) {
+                        const auto &words = aSignatures[idx]._words;
+                        __m128i missing = _mm_setzero_si128();
+
+                        for (std::size_t lane = 0; lane < laneCount; lane++) {
+                            const __m128i bits =
+                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&words[lane * 2])); // NOLINT
+
+                            missing = _mm_or_si128(missing, _mm_andnot_si128(bits, mask[lane]));
+                        }
+                        if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == allEqual) {
+                            aOut.push_back(idx);
+                        }
+                    }
+                    return;
+                }
+#endif
+                for (std::size_t idx = 0; idx < aSignatures.size(); idx++) {
+                    if (aSignatures[idx].contains(aMask)) {
+                        aOut.push_back(idx);
+                    }
+                }
+            }
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !SIGNATURE_HPP_ */
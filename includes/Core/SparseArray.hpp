@@ -5,9 +5,15 @@
 #ifndef SPARSEARRAY_HPP_
 #define SPARSEARRAY_HPP_
 
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <optional>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
+#include "ChangeTicks.hpp"
 #include "Exception.hpp"
 
 namespace Engine::Core {
@@ -15,15 +21,65 @@ namespace Engine::Core {
     DEFINE_EXCEPTION_FROM(SparseArrayExceptionOutOfRange, SparseArrayException);
     DEFINE_EXCEPTION_FROM(SparseArrayExceptionEmpty, SparseArrayException);
 
+    /**
+     * @brief The memory layout used by a SparseArray
+     * @details Dense keeps one optional slot per entity id, which is the best choice for components held by most
+     * entities. SparseSet packs the live components contiguously and keeps a sparse id -> slot index, which is the best
+     * choice for components held by few entities: memory and iteration only scale with the live components.
+     */
+    enum class ComponentStorage
+    {
+        Dense,
+        SparseSet
+    };
+
+    /**
+     * @brief Type erased interface of a SparseArray, used by the World to reach every component pool without knowing
+     * the component types
+     */
+    class ISparseArray
+    {
+        public:
+            ISparseArray() = default;
+            virtual ~ISparseArray() = default;
+
+            ISparseArray(const ISparseArray &other) = default;
+            ISparseArray &operator=(const ISparseArray &other) = default;
+
+            ISparseArray(ISparseArray &&other) noexcept = default;
+            ISparseArray &operator=(ISparseArray &&other) noexcept = default;
+
+            /**
+             * @brief Make an index addressable and empty
+             *
+             * @param aIndex The index to init
+             */
+            virtual void init(std::size_t aIndex) = 0;
+
+            /**
+             * @brief Empty an index
+             *
+             * @param aIndex The index to erase
+             */
+            virtual void erase(std::size_t aIndex) = 0;
+    };
+
     /**
      * @brief SparseArray is a class that store a vector of optional of a given type
      * It represents a ONE component type, each index in the array represent the component of the entity at the same
      * index
+     * @details In ComponentStorage::SparseSet mode the components are packed in a dense array, a second dense array
+     * stores the entity owning each packed component and a sparse array maps the entity index to its packed slot.
+     * Erasing swaps the last packed component into the hole so the packed arrays never contain holes.
+     * Each component keeps the tick it was added at and the tick it was last changed at, for the Added / Changed query
+     * terms. Inserting a component and the mutable accessors (get, operator[], set and emplace over a set component)
+     * stamp the tick of the running system, or the tick of the World outside of the systems. getUnchecked and forEach
+     * don't, the queries stamp the components they give as mutable themselves.
      *
      * @tparam Component The type of the components to store
      */
     template<typename Component>
-    class SparseArray final
+    class SparseArray final : public ISparseArray
     {
         public:
             using compRef = Component &;
@@ -34,14 +90,34 @@ namespace Engine::Core {
             using vectIndex = typename vectArray::size_type;
             using iterator = typename vectArray::iterator;
             using constIterator = typename vectArray::const_iterator;
+            /// every packed slot is set, so the iterators walk them like the slots of the Dense mode
+            using packedArray = vectArray;
+            using entityArray = std::vector<vectIndex>;
+            using slotIndex = std::uint32_t;
+            using slotArray = std::vector<slotIndex>;
+
+            static constexpr slotIndex npos = std::numeric_limits<slotIndex>::max();
 
         private:
+            ComponentStorage _storage = ComponentStorage::Dense;
             vectArray _array;
+            packedArray _packed;
+            entityArray _entities;
+            slotArray _sparse;
+            vectIndex _count = 0;
+            /// indexed like _array in Dense mode, like _packed in SparseSet mode
+            std::vector<tick> _addedTicks;
+            std::vector<tick> _changedTicks;
+            std::size_t _world = ChangeTicks::noWorld;
+            const std::atomic<tick> *_tickSource = nullptr;
 
         public:
 #pragma region constructors / destructors
             SparseArray() = default;
-            ~SparseArray() = default;
+            explicit SparseArray(ComponentStorage aStorage)
+                : _storage(aStorage)
+            {}
+            ~SparseArray() override = default;
 
             SparseArray(const SparseArray &other) = default;
             SparseArray &operator=(const SparseArray &other) = default;
@@ -61,13 +137,14 @@ namespace Engine::Core {
              */
             compRef operator[](vectIndex aIndex)
             {
-                if (aIndex >= _array.size() || aIndex < 0) {
+                if (aIndex >= size()) {
                     throw SparseArrayExceptionOutOfRange("index out of range: " + std::to_string(aIndex));
                 }
-                if (!_array[aIndex].has_value()) {
+                if (!hasUnchecked(aIndex)) {
                     throw SparseArrayExceptionEmpty("index is empty: " + std::to_string(aIndex));
                 }
-                return _array[aIndex].value();
+                markChanged(aIndex, currentTick());
+                return getUnchecked(aIndex);
             }
 
             /**
@@ -79,13 +156,13 @@ namespace Engine::Core {
              */
             constCompRef operator[](vectIndex aIndex) const
             {
-                if (aIndex >= _array.size() || aIndex < 0) {
+                if (aIndex >= size()) {
                     throw SparseArrayExceptionOutOfRange("index out of range: " + std::to_string(aIndex));
                 }
-                if (!_array[aIndex].has_value()) {
+                if (!hasUnchecked(aIndex)) {
                     throw SparseArrayExceptionEmpty("index is empty: " + std::to_string(aIndex));
                 }
-                return _array[aIndex].value();
+                return getUnchecked(aIndex);
             }
 
 #pragma endregion operators
@@ -101,13 +178,14 @@ namespace Engine::Core {
              */
             compRef get(vectIndex aIndex)
             {
-                if (aIndex >= _array.size() || aIndex < 0) {
+                if (aIndex >= size()) {
                     throw SparseArrayExceptionOutOfRange("index out of range: " + std::to_string(aIndex));
                 }
-                if (!_array[aIndex].has_value()) {
+                if (!hasUnchecked(aIndex)) {
                     throw SparseArrayExceptionEmpty("index is empty: " + std::to_string(aIndex));
                 }
-                return _array[aIndex].value();
+                markChanged(aIndex, currentTick());
+                return getUnchecked(aIndex);
             }
 
             /**
@@ -118,25 +196,28 @@ namespace Engine::Core {
              */
             void set(vectIndex aIndex, Component &&aValue)
             {
-                if (aIndex >= _array.size() || aIndex < 0) {
+                if (aIndex >= size()) {
                     throw SparseArrayExceptionOutOfRange("index out of range: " + std::to_string(aIndex));
                 }
-                _array[aIndex] = std::move(aValue);
+                if (hasUnchecked(aIndex)) {
+                    markChanged(aIndex, currentTick());
+                    getUnchecked(aIndex) = std::move(aValue);
+                    return;
+                }
+                insert(aIndex, std::move(aValue));
             }
 
             /**
              * @brief Check if the component at the given index is set
-             * @throw SparseArrayExceptionOutOfRange if the index is out of range
+             * @details The pools only grow when a component is set, so an index past the end (like an entity created
+             * since) has no component
              * @param index The index to check
              * @return true if the component is set
              * @return false if the component is not set
              */
             bool has(vectIndex aIndex) const
             {
-                if (aIndex >= _array.size() || aIndex < 0) {
-                    throw SparseArrayExceptionOutOfRange("index out of range: " + std::to_string(aIndex));
-                }
-                return _array[aIndex].has_value();
+                return contains(aIndex);
             }
 
             /**
@@ -144,12 +225,27 @@ namespace Engine::Core {
              * std::nullopt
              * @param index The index to set
              */
-            void init(vectIndex aIndex)
+            void init(vectIndex aIndex) override
+            {
+                if (aIndex >= size()) {
+                    grow(aIndex + 1);
+                    return;
+                }
+                if (hasUnchecked(aIndex)) {
+                    remove(aIndex);
+                }
+            }
+
+            /**
+             * @brief Make the array cover at least a number of indexes, never shrinks it
+             *
+             * @param aSize The number of indexes to cover
+             */
+            void extend(vectIndex aSize)
             {
-                if (aIndex >= _array.size()) {
-                    _array.resize(aIndex + 1, std::nullopt);
+                if (aSize > size()) {
+                    grow(aSize);
                 }
-                _array[aIndex] = std::nullopt;
             }
 
             /**
@@ -162,11 +258,17 @@ namespace Engine::Core {
             template<typename... Args>
             compRef emplace(vectIndex aIndex, Args &&...aArgs)
             {
-                if (aIndex >= _array.size()) {
-                    _array.resize(aIndex + 1);
+                if (aIndex >= size()) {
+                    grow(aIndex + 1);
                 }
-                _array[aIndex].emplace(Component(std::forward<Args>(aArgs)...));
-                return _array[aIndex].value();
+                if (!hasUnchecked(aIndex)) {
+                    return insert(aIndex, Component(std::forward<Args>(aArgs)...));
+                }
+                markChanged(aIndex, currentTick());
+                if (_storage == ComponentStorage::SparseSet) {
+                    return getUnchecked(aIndex) = Component(std::forward<Args>(aArgs)...);
+                }
+                return _array[aIndex].emplace(Component(std::forward<Args>(aArgs)...));
             }
 
             /**
@@ -175,12 +277,14 @@ namespace Engine::Core {
              * @throw SparseArrayExceptionOutOfRange if the index is out of range
              * @param index The index to erase
              */
-            void erase(vectIndex aIndex)
+            void erase(vectIndex aIndex) override
             {
-                if (aIndex >= _array.size() || aIndex < 0) {
+                if (aIndex >= size()) {
                     throw SparseArrayExceptionOutOfRange("index out of range: " + std::to_string(aIndex));
                 }
-                _array[aIndex].reset();
+                if (hasUnchecked(aIndex)) {
+                    remove(aIndex);
+                }
             }
 
             /**
@@ -189,48 +293,311 @@ namespace Engine::Core {
             void clear()
             {
                 _array.clear();
+                _packed.clear();
+                _entities.clear();
+                _sparse.clear();
+                _addedTicks.clear();
+                _changedTicks.clear();
+                _count = 0;
+            }
+
+            /**
+             * @brief Check if the component at the given index is set, without throwing
+             *
+             * @param aIndex The index to check
+             * @return true if the index is in range and the component is set
+             */
+            [[nodiscard]] bool contains(vectIndex aIndex) const noexcept
+            {
+                return aIndex < size() && hasUnchecked(aIndex);
+            }
+
+            /**
+             * @brief Check if the component at the given index is set, without any bound check
+             * @details The index must be lower than size()
+             * @param aIndex The index to check
+             * @return true if the component is set
+             */
+            [[nodiscard]] bool hasUnchecked(vectIndex aIndex) const
+            {
+                if (_storage == ComponentStorage::SparseSet) {
+                    return _sparse[aIndex] != npos;
+                }
+                return _array[aIndex].has_value();
+            }
+
+            /**
+             * @brief Get the component at the given index, without any bound or emptiness check
+             * @details hasUnchecked(aIndex) must be true
+             * @param aIndex The index to get
+             * @return compRef The component at the given index
+             */
+            compRef getUnchecked(vectIndex aIndex)
+            {
+                if (_storage == ComponentStorage::SparseSet) {
+                    return *_packed[_sparse[aIndex]];
+                }
+                return *_array[aIndex];
+            }
+
+            /**
+             * @brief Get the component at the given index, without any bound or emptiness check
+             * @details hasUnchecked(aIndex) must be true
+             * @param aIndex The index to get
+             * @return constCompRef The component at the given index
+             */
+            constCompRef getUnchecked(vectIndex aIndex) const
+            {
+                if (_storage == ComponentStorage::SparseSet) {
+                    return *_packed[_sparse[aIndex]];
+                }
+                return *_array[aIndex];
+            }
+
+            /**
+             * @brief Get the tick a component was added at
+             * @details hasUnchecked(aIndex) must be true
+             * @param aIndex The index of the component
+             * @return tick The tick of the system (or of the World) which added it
+             */
+            [[nodiscard]] tick getAddedTick(vectIndex aIndex) const
+            {
+                return _addedTicks[slotOf(aIndex)];
+            }
+
+            /**
+             * @brief Get the tick a component was last changed at
+             * @details hasUnchecked(aIndex) must be true
+             * @param aIndex The index of the component
+             * @return tick The tick of the last mutable access, the one it was added at if none
+             */
+            [[nodiscard]] tick getChangedTick(vectIndex aIndex) const
+            {
+                return _changedTicks[slotOf(aIndex)];
+            }
+
+            /**
+             * @brief Mark a component as changed
+             * @details hasUnchecked(aIndex) must be true
+             * @param aIndex The index of the component
+             * @param aTick The tick of the change
+             */
+            void markChanged(vectIndex aIndex, tick aTick)
+            {
+                _changedTicks[slotOf(aIndex)] = aTick;
+            }
+
+            /**
+             * @brief Set where the ticks of the changes made outside of the systems come from, done by the World
+             *
+             * @param aWorld The id of the World, the ticks of its running systems are used instead
+             * @param aTickSource The current tick of the World
+             */
+            void setTickSource(std::size_t aWorld, const std::atomic<tick> *aTickSource)
+            {
+                _world = aWorld;
+                _tickSource = aTickSource;
+            }
+
+            /**
+             * @brief Call a function on each live component
+             * @details Only the packed arrays are walked in SparseSet mode, the holes are skipped in Dense mode
+             * @param aFunc The function to call, with the entity index and the component
+             */
+            template<typename Func>
+            void forEach(Func &&aFunc)
+            {
+                if (_storage == ComponentStorage::SparseSet) {
+                    for (vectIndex slot = 0; slot < _packed.size(); slot++) {
+                        aFunc(_entities[slot], *_packed[slot]);
+                    }
+                    return;
+                }
+                for (vectIndex idx = 0; idx < _array.size(); idx++) {
+                    if (_array[idx].has_value()) {
+                        aFunc(idx, *_array[idx]);
+                    }
+                }
+            }
+
+            /**
+             * @brief Get the memory layout of the array
+             *
+             * @return ComponentStorage The storage mode
+             */
+            [[nodiscard]] ComponentStorage getStorage() const
+            {
+                return _storage;
+            }
+
+            /**
+             * @brief Get the number of live components
+             *
+             * @return vectIndex The number of set components
+             */
+            [[nodiscard]] vectIndex count() const
+            {
+                return _count;
+            }
+
+            /**
+             * @brief Get the packed components (SparseSet mode only, empty otherwise)
+             *
+             * @return std::span<optComponent> The live components, in packed order, all set
+             */
+            std::span<optComponent> packed()
+            {
+                return _packed;
+            }
+
+            /**
+             * @brief Get the entity owning each packed component (SparseSet mode only, empty otherwise)
+             *
+             * @return std::span<const vectIndex> The entity indexes, in packed order
+             */
+            [[nodiscard]] std::span<const vectIndex> entities() const
+            {
+                return _entities;
             }
 
 #pragma endregion methods
 
 #pragma region iterator
 
+            // The iterators walk the optional slots of the Dense mode, the packed components in SparseSet mode (all
+            // set, in the order of entities()). forEach visits the live components with their entity in any mode.
             iterator begin()
             {
-                return _array.begin();
+                return _storage == ComponentStorage::SparseSet ? _packed.begin() : _array.begin();
             }
 
             iterator end()
             {
-                return _array.end();
+                return _storage == ComponentStorage::SparseSet ? _packed.end() : _array.end();
             }
 
             constIterator begin() const
             {
-                return _array.begin();
+                return _storage == ComponentStorage::SparseSet ? _packed.begin() : _array.begin();
             }
 
             constIterator end() const
             {
-                return _array.end();
+                return _storage == ComponentStorage::SparseSet ? _packed.end() : _array.end();
             }
 
             constIterator cbegin() const
             {
-                return _array.cbegin();
+                return _storage == ComponentStorage::SparseSet ? _packed.cbegin() : _array.cbegin();
             }
 
             constIterator cend() const
             {
-                return _array.cend();
+                return _storage == ComponentStorage::SparseSet ? _packed.cend() : _array.cend();
             }
 
             vectIndex size() const
             {
+                if (_storage == ComponentStorage::SparseSet) {
+                    return _sparse.size();
+                }
                 return _array.size();
             }
 
 #pragma endregion iterator
+
+        private:
+            /**
+             * @brief Make the indexes lower than aSize addressable
+             *
+             * @param aSize The new number of slots
+             */
+            void grow(vectIndex aSize)
+            {
+                if (_storage == ComponentStorage::SparseSet) {
+                    _sparse.resize(aSize, npos);
+                    return;
+                }
+                _array.resize(aSize, std::nullopt);
+                _addedTicks.resize(aSize, 0);
+                _changedTicks.resize(aSize, 0);
+            }
+
+            /**
+             * @brief Get the slot of the ticks of a set index
+             */
+            [[nodiscard]] vectIndex slotOf(vectIndex aIndex) const
+            {
+                return _storage == ComponentStorage::SparseSet ? _sparse[aIndex] : aIndex;
+            }
+
+            /**
+             * @brief Get the tick the changes are made at on the calling thread
+             *
+             * @return tick The tick of the running system of the World, else the tick of the World
+             */
+            [[nodiscard]] tick currentTick() const
+            {
+                const auto &ticks = ChangeTicks::getCurrent();
+
+                if (ticks.world == _world) {
+                    return ticks.thisRun;
+                }
+                return _tickSource != nullptr ? _tickSource->load(std::memory_order_relaxed) : 0;
+            }
+
+            /**
+             * @brief Store a component at an empty index
+             *
+             * @param aIndex The index to set, must be empty
+             * @param aValue The value to move in
+             * @return compRef The stored component
+             */
+            compRef insert(vectIndex aIndex, Component &&aValue)
+            {
+                const tick now = currentTick();
+
+                _count++;
+                if (_storage == ComponentStorage::SparseSet) {
+                    _sparse[aIndex] = static_cast<slotIndex>(_packed.size());
+                    _entities.push_back(aIndex);
+                    _addedTicks.push_back(now);
+                    _changedTicks.push_back(now);
+                    return _packed.emplace_back(std::move(aValue)).value();
+                }
+                _addedTicks[aIndex] = now;
+                _changedTicks[aIndex] = now;
+                return _array[aIndex].emplace(std::move(aValue));
+            }
+
+            /**
+             * @brief Destroy the component at a set index, swapping the last packed component in its slot
+             *
+             * @param aIndex The index to remove, must be set
+             */
+            void remove(vectIndex aIndex)
+            {
+                _count--;
+                if (_storage == ComponentStorage::Dense) {
+                    _array[aIndex].reset();
+                    return;
+                }
+                const slotIndex slot = _sparse[aIndex];
+                const vectIndex last = _packed.size() - 1;
+
+                if (slot != last) {
+                    _packed[slot] = std::move(_packed[last]);
+                    _entities[slot] = _entities[last];
+                    _addedTicks[slot] = _addedTicks[last];
+                    _changedTicks[slot] = _changedTicks[last];
+                    _sparse[_entities[slot]] = slot;
+                }
+                _packed.pop_back();
+                _entities.pop_back();
+                _addedTicks.pop_back();
+                _changedTicks.pop_back();
+                _sparse[aIndex] = npos;
+            }
     };
 } // namespace Engine::Core
 
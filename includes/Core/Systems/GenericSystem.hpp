@@ -3,11 +3,18 @@
 
 #include <functional>
 #include <utility>
-#include "Core/Clock.hpp"
 #include "Core/World.hpp"
 #include "System.hpp"
 
 namespace Engine::Core {
+    /**
+     * @brief A system calling a function on each entity of a query
+     * @details The access of the system is inferred from the components: a const component is read, the other ones
+     * are written. A system without component may touch anything and keeps running alone. The other ones run alongside
+     * each other, so they record their structural changes (entities created or killed, components added or removed) in
+     * World::getCommandBuffer, the World throwing WorldExceptionSystemsRunning otherwise. The deltaTime given to the
+     * function is the one set by the World (see System::setFrameTime).
+     */
     template<typename Func, typename... Components>
     class GenericSystem : public System
     {
@@ -15,18 +22,31 @@ namespace Engine::Core {
             GenericSystem(Core::World &world, Func updateFunc)
                 : _world(world),
                   _updateFunc(updateFunc)
-            {}
+            {
+                if constexpr (sizeof...(Components) > 0) {
+                    const auto &access = World::getQueryAccess<Components...>();
+
+                    setAccess(access.reads, access.writes);
+                }
+            }
+
+            void prepare() override
+            {
+                if (_query == nullptr) {
+                    _query = &_world.get().template registerQuery<Components...>();
+                }
+            }
 
             void update() override
             {
-                double deltaTime = _clock.getElapsedTime();
-                _world.get().template query<Components...>().forEach(deltaTime, _updateFunc);
+                prepare();
+                _query->forEach(getDeltaTime(), _updateFunc);
             }
 
         private:
             std::reference_wrapper<Core::World> _world;
             Func _updateFunc;
-            Clock _clock;
+            World::CachedQuery<Components...> *_query = nullptr;
     };
 
     template<typename... Components, typename Func>
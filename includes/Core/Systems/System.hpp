@@ -1,6 +1,14 @@
 #ifndef SYSTEM_HPP_
 #define SYSTEM_HPP_
 
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Core/ChangeTicks.hpp"
+#include "Core/FixedTimestep.hpp"
+#include "Core/Signature.hpp"
+
 namespace Engine::Core {
     class System
     {
@@ -9,16 +17,183 @@ namespace Engine::Core {
             virtual ~System() = default;
             virtual void update() = 0;
 
+            /**
+             * @brief Called by the World on its own thread before the systems of a frame run
+             * @details Systems may run alongside each other, this is the place for the structural changes they need
+             * once (like registering their query)
+             */
+            virtual void prepare()
+            {}
+
             System &operator=(const System &) = default;
             System &operator=(System &&) = default;
 
             System(const System &) = default;
             System(System &&) = default;
 
+            /**
+             * @brief Declare the components the system reads and writes
+             * @details A system with declared access only runs alongside the systems it doesn't conflict with, a system
+             * without runs alone. The declared systems must not make structural changes in update, they record them in
+             * World::getCommandBuffer instead.
+             * @param aReads The components read
+             * @param aWrites The components written
+             */
+            void setAccess(const Signature &aReads, const Signature &aWrites)
+            {
+                _reads = aReads;
+                _writes = aWrites;
+                _hasAccess = true;
+            }
+
+            [[nodiscard]] bool hasAccess() const
+            {
+                return _hasAccess;
+            }
+
+            [[nodiscard]] const Signature &getReads() const
+            {
+                return _reads;
+            }
+
+            [[nodiscard]] const Signature &getWrites() const
+            {
+                return _writes;
+            }
+
+            /**
+             * @brief Check if two systems can't run at the same time
+             *
+             * @param aOther The other system
+             * @return true if one of them has no declared access or writes a component the other one accesses
+             */
+            [[nodiscard]] bool conflictsWith(const System &aOther) const
+            {
+                if (!_hasAccess || !aOther._hasAccess) {
+                    return true;
+                }
+                return _writes.intersects(aOther._writes) || _writes.intersects(aOther._reads)
+                    || _reads.intersects(aOther._writes);
+            }
+
+            /**
+             * @brief Make the system run before another one, whatever their access
+             *
+             * @param aSystem The name of the other system
+             * @return System& The system, to chain the constraints
+             */
+            System &runBefore(std::string aSystem)
+            {
+                _before.push_back(std::move(aSystem));
+                return *this;
+            }
+
+            /**
+             * @brief Make the system run after another one, whatever their access
+             *
+             * @param aSystem The name of the other system
+             * @return System& The system, to chain the constraints
+             */
+            System &runAfter(std::string aSystem)
+            {
+                _after.push_back(std::move(aSystem));
+                return *this;
+            }
+
+            [[nodiscard]] const std::vector<std::string> &getBefore() const
+            {
+                return _before;
+            }
+
+            [[nodiscard]] const std::vector<std::string> &getAfter() const
+            {
+                return _after;
+            }
+
+            /**
+             * @brief Run the system at a fixed rate instead of once per frame
+             * @details A frame runs the system as many times as the time accumulated allows, up to aMaxSteps times,
+             * each time with a deltaTime of one step
+             * @param aHertz The number of runs per second, 0 to run once per frame
+             * @param aMaxSteps The max number of runs in one frame
+             * @return System& The system, to chain the settings
+             */
+            System &setTickRate(double aHertz, std::size_t aMaxSteps = FixedTimestep::defaultMaxSteps)
+            {
+                _timestep = FixedTimestep(aHertz, aMaxSteps);
+                return *this;
+            }
+
+            [[nodiscard]] FixedTimestep &getTimestep()
+            {
+                return _timestep;
+            }
+
+            [[nodiscard]] const FixedTimestep &getTimestep() const
+            {
+                return _timestep;
+            }
+
+            /**
+             * @brief Set the time of the next runs, done by the World before they start
+             *
+             * @param aDeltaTime The time of the frame (or of one step at a fixed rate) in milliseconds
+             * @param aAlpha The interpolation factor between the last two fixed steps, see World::getAlpha
+             */
+            void setFrameTime(double aDeltaTime, double aAlpha)
+            {
+                _deltaTime = aDeltaTime;
+                _alpha = aAlpha;
+            }
+
+            [[nodiscard]] double getDeltaTime() const
+            {
+                return _deltaTime;
+            }
+
+            [[nodiscard]] double getAlpha() const
+            {
+                return _alpha;
+            }
+
+            /**
+             * @brief Take the tick of the next run, done by the World before it starts
+             *
+             * @param aWorld The id of the World
+             * @param aTick The tick of the run, newer than the ones given before
+             * @return ChangeTicks The ticks the queries of the run compare the components against
+             */
+            ChangeTicks beginRun(std::size_t aWorld, tick aTick)
+            {
+                const ChangeTicks ticks {aWorld, _lastRun, aTick};
+
+                _lastRun = aTick;
+                return ticks;
+            }
+
+            /**
+             * @brief Get the tick of the last run
+             *
+             * @return tick The tick, 0 if the system never ran
+             */
+            [[nodiscard]] tick getLastRunTick() const
+            {
+                return _lastRun;
+            }
+
         public:
             bool _isActivated = true;
 
         private:
+            Signature _reads;
+            Signature _writes;
+            bool _hasAccess = false;
+            std::vector<std::string> _before;
+            std::vector<std::string> _after;
+            FixedTimestep _timestep;
+            double _deltaTime = 0;
+            double _alpha = 0;
+            tick _lastRun = 0;
     };
 } // namespace Engine::Core
 
@@ -0,0 +1,117 @@
+#ifndef SYSTEMSCHEDULER_HPP_
+#define SYSTEMSCHEDULER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Core/ChangeTicks.hpp"
+#include "Core/JobSystem.hpp"
+#include "Exception.hpp"
+#include "System.hpp"
+
+namespace Engine::Core {
+    DEFINE_EXCEPTION(SystemSchedulerException);
+    DEFINE_EXCEPTION_FROM(SystemSchedulerExceptionUnknownSystem, SystemSchedulerException);
+    DEFINE_EXCEPTION_FROM(SystemSchedulerExceptionCycle, SystemSchedulerException);
+
+    /**
+     * @brief The stages of a frame, in the order they run
+     */
+    enum class Stage : std::uint8_t {
+        PreUpdate,
+        Update,
+        PostUpdate,
+        Render,
+    };
+
+    constexpr std::size_t stageCount = 4;
+
+    /**
+     * @brief Dependency graph of the systems of a World, run as jobs
+     * @details The systems are first ordered by their stage and their runBefore / runAfter constraints, ties keeping
+     * the order they were given in. Every system of a stage depends on the systems of the previous stage. Then each
+     * system depends on the previous ones it conflicts with (see System::conflictsWith), so the conflicting systems
+     * keep running one after the other while the other ones run at the same time. A frame lasts as long as the longest
+     * chain of dependent systems.
+     */
+    class SystemScheduler final
+    {
+        public:
+            struct entry
+            {
+                    std::string name;
+                    System *system;
+                    Stage stage;
+            };
+
+        private:
+            std::vector<System *> _systems;
+            std::vector<std::string> _names;
+            std::vector<std::vector<std::size_t>> _successors;
+            std::vector<std::vector<std::size_t>> _predecessors;
+            double _alpha = 0;
+
+        public:
+#pragma region methods
+            /**
+             * @brief Build the graph of a list of systems
+             * @throw SystemSchedulerExceptionUnknownSystem if a constraint names a system which isn't in the list
+             * @throw SystemSchedulerExceptionCycle if the constraints can't all be met, a constraint going against the
+             * order of the stages included
+             * @param aSystems The named systems, sorted by stage, in their default order
+             */
+            void build(const std::vector<entry> &aSystems);
+
+            /**
+             * @brief Run a frame, each system as soon as the systems it depends on are done
+             * @details The systems with a tick rate run as many steps as their timestep gives, one pass of the graph
+             * per step, the systems without run once in the last pass (so after every fixed step) with the alpha of
+             * the fastest fixed rate system. Each system of a pass is a job spawned after the jobs of the systems it
+             * depends on, the skipped ones (deactivated or without step this pass) only forward the dependencies. The
+             * systems depending on a failing one are skipped, the other ones end the pass, then the first exception is
+             * rethrown. Each run of a system takes the next tick of the World and sees it as current, see
+             * ChangeTicks. The systems with declared access are counted in aConcurrent while they run, the World
+             * refusing the structural changes meanwhile.
+             * @param aJobs The job system to run on, the calling thread takes part
+             * @param aElapsed The time of the frame in milliseconds
+             * @param aWorld The id of the World the systems belong to
+             * @param aTick The current tick of the World
+             * @param aConcurrent The number of systems with declared access running
+             */
+            void run(JobSystem &aJobs, double aElapsed, std::size_t aWorld, std::atomic<tick> &aTick,
+                     std::atomic<std::size_t> &aConcurrent);
+
+            /**
+             * @brief Get the interpolation factor given to the variable rate systems by the last run
+             *
+             * @return double The alpha of the fastest fixed rate system, 0 without any
+             */
+            [[nodiscard]] double getAlpha() const;
+
+            /**
+             * @brief Check if a system waits for another one, directly or not
+             *
+             * @param aSystem The name of the system
+             * @param aOther The name of the other system
+             * @return true if aSystem never starts before aOther is done
+             */
+            [[nodiscard]] bool dependsOn(const std::string &aSystem, const std::string &aOther) const;
+
+            /**
+             * @brief Get the number of systems of the longest chain of dependent systems
+             *
+             * @return std::size_t The length of the critical path, 0 without system
+             */
+            [[nodiscard]] std::size_t getCriticalPathLength() const;
+
+        private:
+            void runPass(JobSystem &aJobs, const std::vector<bool> &aActive, std::size_t aWorld,
+                         std::atomic<tick> &aTick, std::atomic<std::size_t> &aConcurrent);
+            [[nodiscard]] std::size_t find(const std::string &aName) const;
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !SYSTEMSCHEDULER_HPP_ */
@@ -0,0 +1,433 @@
+#ifndef TASK_HPP_
+#define TASK_HPP_
+
+#include <algorithm>
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "Events/EventsManager.hpp"
+#include "Exception.hpp"
+#include "JobSystem.hpp"
+
+namespace Engine::Core {
+    DEFINE_EXCEPTION(TaskException);
+
+    /**
+     * @brief Recycles the frames of the coroutines, so the tasks started and finished every frame don't hit the heap
+     * @details The frames are rounded up to a size class, each class keeps a free list of blocks carved from slabs of
+     * slabBlocks blocks. The slabs are only released with the pool. The frames bigger than maxPooledSize go to the
+     * heap.
+     */
+    class TaskPool final
+    {
+        public:
+            static constexpr std::size_t blockAlign = 64;
+            static constexpr std::size_t maxPooledSize = 1024;
+            static constexpr std::size_t slabBlocks = 64;
+
+        private:
+            struct FreeBlock
+            {
+                    FreeBlock *next;
+            };
+
+            struct SizeClass
+            {
+                    std::mutex mutex;
+                    FreeBlock *free = nullptr;
+                    std::vector<std::unique_ptr<std::byte[]>> slabs;
+            };
+
+            std::array<SizeClass, maxPooledSize / blockAlign> _classes;
+
+        public:
+#pragma region constructors / destructors
+            TaskPool() = default;
+            ~TaskPool() = default;
+
+            TaskPool(const TaskPool &other) = delete;
+            TaskPool &operator=(const TaskPool &other) = delete;
+
+            TaskPool(TaskPool &&other) noexcept = delete;
+            TaskPool &operator=(TaskPool &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Take a block of at least aSize bytes
+             *
+             * @param aSize The size of the coroutine frame
+             * @return void* The block, aligned like operator new
+             */
+            void *allocate(std::size_t aSize);
+
+            /**
+             * @brief Give a block back to its size class
+             *
+             * @param aBlock The block, from allocate
+             * @param aSize The size given to allocate
+             */
+            void deallocate(void *aBlock, std::size_t aSize) noexcept;
+
+            /**
+             * @brief Get the number of blocks carved from the slabs, used or free
+             *
+             * @return std::size_t The number of blocks of every size class
+             */
+            [[nodiscard]] std::size_t getReservedBlocks();
+
+            /**
+             * @brief Get the pool the frames of every Task come from
+             *
+             * @return TaskPool& The pool
+             */
+            static TaskPool &getShared();
+#pragma endregion methods
+    };
+
+    /**
+     * @brief A coroutine run by a World over several frames, see World::startTask
+     * @details The coroutine doesn't run until the World starts it, then co_awaits the awaitables of its
+     * TaskScheduler: nextFrame, delay, waitJob and waitEvent. The Task owns the coroutine until it is started.
+     */
+    class Task final
+    {
+        public:
+            struct promise_type
+            {
+                    std::exception_ptr error;
+
+                    Task get_return_object()
+                    {
+                        return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+                    }
+
+                    std::suspend_always initial_suspend() noexcept
+                    {
+                        return {};
+                    }
+
+                    std::suspend_always final_suspend() noexcept
+                    {
+                        return {};
+                    }
+
+                    void return_void()
+                    {}
+
+                    void unhandled_exception()
+                    {
+                        error = std::current_exception();
+                    }
+
+                    static void *operator new(std::size_t aSize)
+                    {
+                        return TaskPool::getShared().allocate(aSize);
+                    }
+
+                    static void operator delete(void *aBlock, std::size_t aSize) noexcept
+                    {
+                        TaskPool::getShared().deallocate(aBlock, aSize);
+                    }
+            };
+
+            using handle = std::coroutine_handle<promise_type>;
+
+        private:
+            handle _handle;
+
+        public:
+#pragma region constructors / destructors
+            explicit Task(handle aHandle);
+            ~Task();
+
+            Task(const Task &other) = delete;
+            Task &operator=(const Task &other) = delete;
+
+            Task(Task &&other) noexcept;
+            Task &operator=(Task &&other) noexcept;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Give up the ownership of the coroutine
+             *
+             * @return handle The coroutine, to destroy once done
+             */
+            handle release();
+#pragma endregion methods
+    };
+
+    /**
+     * @brief The suspended tasks of a World, resumed by runSystems before the systems run
+     * @details The tasks run on the thread calling runSystems while no system runs, so they can make structural
+     * changes. A task waits on one of the awaitables below, the ones whose wait is over are resumed in the order they
+     * were suspended. The time is the time given to runSystems (the World Clock for runSystems()). Tasks may be
+     * started from the systems, the rest is only used from the tasks.
+     */
+    class TaskScheduler final
+    {
+        public:
+            /**
+             * @brief Check if the wait of a suspended task is over, called with its awaiter before resuming it
+             */
+            using readyFunc = bool (*)(void *aAwaiter, const TaskScheduler &aScheduler);
+
+            /**
+             * @brief Resumes the task in the next frame
+             */
+            struct NextFrame
+            {
+                    TaskScheduler *scheduler;
+
+                    [[nodiscard]] bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    void await_suspend(std::coroutine_handle<> aHandle)
+                    {
+                        scheduler->suspend(aHandle, &TaskScheduler::always, this);
+                    }
+
+                    void await_resume() const noexcept
+                    {}
+            };
+
+            /**
+             * @brief Resumes the task in the first frame at least a number of milliseconds later
+             */
+            struct Delay
+            {
+                    TaskScheduler *scheduler;
+                    double deadline;
+
+                    [[nodiscard]] bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    void await_suspend(std::coroutine_handle<> aHandle)
+                    {
+                        scheduler->suspend(aHandle, &Delay::ready, this);
+                    }
+
+                    void await_resume() const noexcept
+                    {}
+
+                    static bool ready(void *aAwaiter, const TaskScheduler &aScheduler)
+                    {
+                        return aScheduler.getTime() >= static_cast<Delay *>(aAwaiter)->deadline;
+                    }
+            };
+
+            /**
+             * @brief Resumes the task in the first frame after a job is done
+             * @details The error of the job isn't thrown, JobSystem::wait on the handle returns at once and throws it
+             */
+            struct JobWait
+            {
+                    TaskScheduler *scheduler;
+                    JobHandle job;
+
+                    [[nodiscard]] bool await_ready() const noexcept
+                    {
+                        return job.isDone();
+                    }
+
+                    void await_suspend(std::coroutine_handle<> aHandle)
+                    {
+                        scheduler->suspend(aHandle, &JobWait::ready, this);
+                    }
+
+                    void await_resume() const noexcept
+                    {}
+
+                    static bool ready(void *aAwaiter, const TaskScheduler & /*unused*/)
+                    {
+                        return static_cast<JobWait *>(aAwaiter)->job.isDone();
+                    }
+            };
+
+            /**
+             * @brief Resumes the task in the first frame an event of a type was pushed since the wait began
+             * @details The events of the type already drained in the EventManager of the scheduler are skipped, the
+             * ones pushed since the last drain count as new. co_await gives a copy of the first new one
+             */
+            template<typename EventType>
+            struct EventWait
+            {
+                    TaskScheduler *scheduler;
+                    std::size_t seen = 0;
+                    std::optional<EventType> event;
+
+                    [[nodiscard]] bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    void await_suspend(std::coroutine_handle<> aHandle)
+                    {
+                        auto &manager = scheduler->getEventManager();
+
+                        manager.initEventHandler<EventType>();
+                        seen = manager.getEventsByType<EventType>().size();
+                        scheduler->suspend(aHandle, &EventWait::ready, this);
+                    }
+
+                    EventType await_resume()
+                    {
+                        return std::move(*event);
+                    }
+
+                    static bool ready(void *aAwaiter, const TaskScheduler &aScheduler)
+                    {
+                        auto &awaiter = *static_cast<EventWait *>(aAwaiter);
+                        const auto &events = aScheduler.getEventManager().getEventsByType<EventType>();
+
+                        // the events cleared meanwhile can't be waited for anymore
+                        awaiter.seen = std::min(awaiter.seen, events.size());
+                        if (events.size() == awaiter.seen) {
+                            return false;
+                        }
+                        awaiter.event.emplace(events[awaiter.seen]);
+                        return true;
+                    }
+            };
+
+        private:
+            struct Waiting
+            {
+                    std::coroutine_handle<> handle;
+                    readyFunc ready;
+                    void *awaiter;
+            };
+
+            std::mutex _mutex;
+            std::vector<Waiting> _waiting;
+            std::vector<Waiting> _resuming;
+            double _time = 0;
+            Engine::Event::EventManager *_events;
+
+        public:
+#pragma region constructors / destructors
+            /**
+             * @brief Construct a new Task Scheduler object, whose tasks wait for the events of the process wide
+             * EventManager
+             */
+            TaskScheduler();
+
+            /**
+             * @brief Construct a new Task Scheduler object
+             *
+             * @param aEvents The EventManager the tasks wait for the events of
+             */
+            explicit TaskScheduler(Engine::Event::EventManager &aEvents);
+
+            /**
+             * @brief Destroy the Task Scheduler object, and with it the tasks which didn't end
+             */
+            ~TaskScheduler();
+
+            TaskScheduler(const TaskScheduler &other) = delete;
+            TaskScheduler &operator=(const TaskScheduler &other) = delete;
+
+            TaskScheduler(TaskScheduler &&other) noexcept = delete;
+            TaskScheduler &operator=(TaskScheduler &&other) noexcept = delete;
+#pragma endregion constructors / destructors
+
+#pragma region methods
+            /**
+             * @brief Take a task, it starts at the next resume
+             *
+             * @param aTask The task, not started yet
+             */
+            void start(Task aTask);
+
+            /**
+             * @brief Advance the time then resume the tasks whose wait is over
+             * @details A task resumed here waiting again is only checked at the next resume. The tasks which end are
+             * destroyed.
+             * @throw The first exception thrown by a task, once every task was resumed
+             * @param aElapsed The time of the frame in milliseconds
+             */
+            void resume(double aElapsed);
+
+            /**
+             * @brief Get the number of tasks started and not ended yet
+             *
+             * @return std::size_t The number of tasks
+             */
+            [[nodiscard]] std::size_t getTaskCount();
+
+            /**
+             * @brief Get the time given to the resumes so far
+             *
+             * @return double The time in milliseconds
+             */
+            [[nodiscard]] double getTime() const;
+
+            /**
+             * @brief Get the EventManager the tasks wait for the events of
+             *
+             * @return Engine::Event::EventManager& The EventManager
+             */
+            [[nodiscard]] Engine::Event::EventManager &getEventManager() const;
+
+            [[nodiscard]] NextFrame nextFrame()
+            {
+                return {this};
+            }
+
+            /**
+             * @brief Wait for a time
+             *
+             * @param aMilliseconds The time to wait, a task waiting for 0 resumes in the next frame
+             * @return Delay The awaitable
+             */
+            [[nodiscard]] Delay delay(double aMilliseconds)
+            {
+                return {this, _time + aMilliseconds};
+            }
+
+            /**
+             * @brief Wait for a job, to run the long work of a task (like loading an asset) on the JobSystem
+             *
+             * @param aJob The handle of the job
+             * @return JobWait The awaitable, ready at once if the job is done
+             */
+            [[nodiscard]] JobWait waitJob(JobHandle aJob)
+            {
+                return {this, std::move(aJob)};
+            }
+
+            /**
+             * @brief Wait for an event pushed in the EventManager of the scheduler
+             *
+             * @tparam EventType The type of the event
+             * @return EventWait<EventType> The awaitable, giving the event
+             */
+            template<typename EventType>
+            [[nodiscard]] EventWait<EventType> waitEvent()
+            {
+                return {this, 0, std::nullopt};
+            }
+
+        private:
+            void suspend(std::coroutine_handle<> aHandle, readyFunc aReady, void *aAwaiter);
+
+            static bool always(void * /*unused*/, const TaskScheduler & /*unused*/)
+            {
+                return true;
+            }
+#pragma endregion methods
+    };
+} // namespace Engine::Core
+
+#endif /* !TASK_HPP_ */
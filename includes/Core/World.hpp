@@ -1,24 +1,59 @@
 #ifndef WORLD_HPP_
 #define WORLD_HPP_
 
-#include <any>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <string>
 #include <tuple>
-#include <typeindex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
+#include "Archetype.hpp"
+#include "ChangeTicks.hpp"
+#include "Clock.hpp"
+#include "CommandBuffer.hpp"
+#include "ComponentRegistry.hpp"
+#include "Entity.hpp"
 #include "Exception.hpp"
+#include "JobSystem.hpp"
+#include "QueryCache.hpp"
+#include "QueryFilters.hpp"
+#include "Signature.hpp"
 #include "SparseArray.hpp"
 #include "Systems/System.hpp"
-#include <boost/container/flat_map.hpp>
+#include "Systems/SystemScheduler.hpp"
+#include "Task.hpp"
 namespace Engine::Core {
     DEFINE_EXCEPTION(WorldException);
     DEFINE_EXCEPTION_FROM(WorldExceptionComponentAlreadyRegistered, WorldException);
     DEFINE_EXCEPTION_FROM(WorldExceptionComponentNotRegistered, WorldException);
+    DEFINE_EXCEPTION_FROM(WorldExceptionTooManyComponents, WorldException);
     DEFINE_EXCEPTION_FROM(WorldExceptionSystemAlreadyRegistered, WorldException);
     DEFINE_EXCEPTION_FROM(WorldExceptionSystemNotRegistered, WorldException);
+    DEFINE_EXCEPTION_FROM(WorldExceptionWrongStorage, WorldException);
+    DEFINE_EXCEPTION_FROM(WorldExceptionStaleEntity, WorldException);
+    DEFINE_EXCEPTION_FROM(WorldExceptionNoSnapshot, WorldException);
+    DEFINE_EXCEPTION_FROM(WorldExceptionSystemsRunning, WorldException);
+
+    /**
+     * @brief The way a World stores its components
+     * @details SparseArrays keeps one SparseArray per component type. Archetypes groups the entities owning the same
+     * set of components in chunks where each component is a contiguous column, so queries reading several components
+     * together walk linear memory, at the cost of moving the entity each time a component is added or removed.
+     */
+    enum class WorldStorage
+    {
+        SparseArrays,
+        Archetypes
+    };
 
     /**
      * @brief The world class represents a level, a scene
@@ -29,118 +64,464 @@ namespace Engine::Core {
     {
         public:
             using id = std::size_t;
-            using containerFunc = std::function<void(World &, const id &)>;
-            using container = std::pair<std::any, std::tuple<containerFunc, containerFunc>>;
-            using containerMap = boost::container::flat_map<std::type_index, container>;
+            using container = std::unique_ptr<ISparseArray>;
+            using containerArray = std::vector<container>;
             using idsContainer = std::vector<id>;
+            using generations = std::vector<Entity::generation>;
+            using signatures = std::vector<Signature>;
             using systemFunc = std::unique_ptr<System>;
             using newSystemFunc = std::pair<std::string, std::unique_ptr<System>>;
-            using systems = boost::container::flat_map<std::string, systemFunc>;
+            using stageSystems = std::vector<newSystemFunc>;
+            using systems = std::array<stageSystems, stageCount>;
+            using queryCaches = std::vector<std::unique_ptr<QueryCache>>;
+            using queryCacheRefs = std::vector<std::vector<QueryCache *>>;
 
         protected:
-            containerMap _components;
+            WorldStorage _storage = WorldStorage::SparseArrays;
+            std::unique_ptr<ArchetypeStorage> _archetypes;
+            containerArray _components;
+            Signature _registered;
             idsContainer _ids;
+            signatures _signatures;
+            generations _generations;
+            std::vector<bool> _alive;
             std::size_t _nextId = 0;
             systems _systems;
+            std::unordered_map<std::string, Stage> _systemStages;
+            SystemScheduler _scheduler;
+            bool _systemsChanged = true;
+            Clock _clock;
+            queryCaches _queries;
+            queryCacheRefs _queriesByComponent;
+            std::size_t _id = takeId();
+            /// the current tick, read by the SparseArrays
+            std::unique_ptr<std::atomic<tick>> _tick = std::make_unique<std::atomic<tick>>(1);
+            /// the systems with declared access running, counted by the SystemScheduler
+            std::unique_ptr<std::atomic<std::size_t>> _concurrentSystems =
+                std::make_unique<std::atomic<std::size_t>>(0);
+            std::vector<std::unique_ptr<CommandBuffer>> _commandBuffers;
+            std::unique_ptr<std::mutex> _commandBuffersMutex = std::make_unique<std::mutex>();
+            CommandBuffer _commands;
+            /// indexed by ComponentRegistry id, the copies read by the Snapshot terms and the functions taking them
+            containerArray _snapshots;
+            std::vector<std::function<void()>> _snapshotCopies;
+            /// the tasks point to it
+            std::unique_ptr<Engine::Event::EventManager> _events = std::make_unique<Engine::Event::EventManager>(false);
+            /// the suspended tasks point to it
+            std::unique_ptr<TaskScheduler> _tasks = std::make_unique<TaskScheduler>(*_events);
 
-            template<typename... Components>
+            /**
+             * @brief Iterate the entities matching a list of terms
+             * @details A term is a component, given to the callback as a reference, or With<T> / Without<T> (matched
+             * but not given) or Optional<T> (given as a pointer, nullptr when missing). The terms are matched against
+             * the signature of the entities, so the callback only sees matching entities. Added<T> / Changed<T> also
+             * require T and keep the entities whose T was added / changed since the last run of the running system,
+             * see World::getChangeTicks.
+             */
+            template<typename... Terms>
             class Query
             {
                 public:
+                    using function = queryFunction<Terms...>;
+
                     explicit Query(Core::World &world)
                         : _world(world)
                     {}
 
-                    void
-                    forEach(double deltaTime,
-                            std::function<void(World &world, double deltaTime, std::size_t idx, Components &...)> func)
+                    void forEach(double deltaTime, function func)
+                    {
+                        run(deltaTime, func);
+                    }
+
+                    /**
+                     * @brief Call any callable on each matching entity, without the std::function indirection
+                     * @details The pools are resolved once before the loop and read without checks once the membership
+                     * is known, so the callable can be inlined in the loop. The SparseSet pool with the fewest live
+                     * components among the required terms drives the iteration, from a copy of its entity list taken
+                     * before the loop, the membership being checked against the signature of the entity: the callable
+                     * may kill entities or add / remove components, the entities which start matching meanwhile may be
+                     * skipped. A Dense pool has a slot per entity, so without SparseSet required term every entity
+                     * index is checked.
+                     */
+                    template<typename Func>
+                    void forEach(double deltaTime, Func &&func)
                     {
-                        for (std::size_t idx = 0; idx < _world.get().getCurrentId(); idx++) {
-                            if (_world.get().template hasComponents<Components...>(idx)) {
-                                func(_world.get(), deltaTime, idx, _world.get().template getComponent<Components>().get(idx)...);
-                            }
+                        run(deltaTime, func);
+                    }
+
+                    /**
+                     * @brief Call a callable on each matching entity from several threads
+                     * @details The matching entities are listed first (the archetype chunks with
+                     * WorldStorage::Archetypes), then the list is split in ranges of aGrain entities run on the jobs.
+                     * Each entity is given to exactly one call. The callable is shared by the threads and must not make
+                     * structural changes (create / kill entities, add / remove components), it records them in
+                     * World::getCommandBuffer instead.
+                     * @param deltaTime The time given to the callable
+                     * @param func The callable
+                     * @param grain The number of entities of a range
+                     * @param jobs The job system to run the ranges on
+                     */
+                    template<typename Func>
+                    void forEachParallel(double deltaTime, Func &&func, std::size_t grain = JobSystem::defaultGrain,
+                                         JobSystem &jobs = JobSystem::getShared())
+                    {
+                        auto &world = _world.get();
+                        const QueryMasks &masks = world.template getQueryMasks<Terms...>();
+
+                        if (world._archetypes) {
+                            (world.template checkRegistered<typename QueryTerm<Terms>::component>(), ...);
+                            World::checkArchetypeTerms<Terms...>();
+                            std::vector<std::pair<Archetype *, std::size_t>> chunks;
+
+                            world._archetypes->forEachChunk(masks.include, masks.exclude,
+                                                            [&chunks](Archetype &archetype, std::size_t chunk) {
+                                                                chunks.emplace_back(&archetype, chunk);
+                                                            });
+                            jobs.parallelFor(chunks.size(), 1,
+                                             [&world, deltaTime, &func, &chunks](std::size_t begin, std::size_t end) {
+                                                 for (std::size_t idx = begin; idx < end; idx++) {
+                                                     world.template runChunk<Terms...>(deltaTime, func,
+                                                                                       *chunks[idx].first,
+                                                                                       chunks[idx].second);
+                                                 }
+                                             });
+                            return;
                         }
+                        const auto entities = world.filterEntities(masks.include, masks.exclude);
+
+                        world.template runParallel<Terms...>(deltaTime, func, entities, grain, jobs);
                     }
 
                 private:
+                    template<typename Func>
+                    void run(double deltaTime, Func &func)
+                    {
+                        auto &world = _world.get();
+                        const QueryMasks &masks = world.template getQueryMasks<Terms...>();
+
+                        if (world._archetypes) {
+                            (world.template checkRegistered<typename QueryTerm<Terms>::component>(), ...);
+                            World::checkArchetypeTerms<Terms...>();
+                            world._archetypes->forEachChunk(
+                                masks.include, masks.exclude,
+                                [&world, deltaTime, &func](Archetype &archetype, std::size_t chunk) {
+                                    world.template runChunk<Terms...>(deltaTime, func, archetype, chunk);
+                                });
+                            return;
+                        }
+                        const ChangeTicks ticks = world.getChangeTicks();
+
+                        std::apply(
+                            [&world, deltaTime, &func, &masks, &ticks](auto &...pools) {
+                                auto visit = [&world, deltaTime, &func, &masks, &ticks,
+                                              &pools...](std::size_t idx, auto & /*unused*/...) {
+                                    if (world.matches(idx, masks)) {
+                                        world.template callFiltered<Terms...>(func, deltaTime, idx, ticks, pools...);
+                                    }
+                                };
+                                constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+                                const std::array<std::size_t, sizeof...(Terms)> counts {
+                                    (QueryTerm<Terms>::required && pools.getStorage() == ComponentStorage::SparseSet
+                                         ? pools.count()
+                                         : none)...};
+                                const auto driver = static_cast<std::size_t>(
+                                    std::distance(counts.begin(), std::min_element(counts.begin(), counts.end())));
+
+                                if (driver == counts.size() || counts[driver] == none) {
+                                    for (std::size_t idx = 0; idx < world.getCurrentId(); idx++) {
+                                        visit(idx);
+                                    }
+                                    return;
+                                }
+                                // the callable may swap-remove from the driving pool, the copy keeps the order
+                                thread_local std::vector<std::size_t> scratch;
+                                std::vector<std::size_t> entities = std::move(scratch);
+                                std::size_t current = 0;
+
+                                entities.clear();
+                                ((current++ == driver
+                                      ? entities.assign(pools.entities().begin(), pools.entities().end())
+                                      : void()),
+                                 ...);
+                                for (const auto idx : entities) {
+                                    visit(idx);
+                                }
+                                scratch = std::move(entities);
+                            },
+                            std::tie(world.template getTermPool<Terms>()...));
+                    }
+
                     std::reference_wrapper<Core::World> _world;
             };
 
         public:
+            /**
+             * @brief A query registered once in the World, which keeps the list of its matching entities up to date
+             * @details Only the changes made through the World (add / emplace / remove a component, create / kill an
+             * entity) are seen. With WorldStorage::Archetypes the archetypes already group the matching entities, the
+             * query walks their chunks and keeps no list. The terms are the same as the ones of World::query.
+             */
+            template<typename... Terms>
+            class CachedQuery final : public QueryCache
+            {
+                public:
+                    using function = queryFunction<Terms...>;
+
+                    explicit CachedQuery(Core::World &world)
+                        : QueryCache(World::getQueryMasks<Terms...>().include,
+                                     World::getQueryMasks<Terms...>().exclude),
+                          _world(world)
+                    {}
+
+                    /**
+                     * @brief Call a function on each matching entity
+                     * @details The list is walked from a copy taken before the first call, so the function may kill
+                     * entities or change their components: each entity is visited at most once, the ones which stop
+                     * matching before their turn are skipped and the ones which start matching wait for the next call
+                     */
+                    void forEach(double deltaTime, function func)
+                    {
+                        run(deltaTime, func);
+                    }
+
+                    /**
+                     * @brief Call any callable on each matching entity, without the std::function indirection
+                     * @details The pools are resolved once and read without checks, every listed entity owning them
+                     */
+                    template<typename Func>
+                    void forEach(double deltaTime, Func &&func)
+                    {
+                        run(deltaTime, func);
+                    }
+
+                    /**
+                     * @brief Call a callable on each matching entity from several threads
+                     * @details The list is split in ranges of aGrain entities, see Query::forEachParallel
+                     */
+                    template<typename Func>
+                    void forEachParallel(double deltaTime, Func &&func, std::size_t grain = JobSystem::defaultGrain,
+                                         JobSystem &jobs = JobSystem::getShared())
+                    {
+                        auto &world = _world.get();
+
+                        if (world._archetypes) {
+                            world.template query<Terms...>().forEachParallel(deltaTime, func, grain, jobs);
+                            return;
+                        }
+                        world.template runParallel<Terms...>(deltaTime, func, getEntities(), grain, jobs);
+                    }
+
+                private:
+                    template<typename Func>
+                    void run(double deltaTime, Func &func)
+                    {
+                        auto &world = _world.get();
+
+                        if (world._archetypes) {
+                            world.template query<Terms...>().forEach(deltaTime, func);
+                            return;
+                        }
+                        const ChangeTicks ticks = world.getChangeTicks();
+                        // taken from the member to keep its capacity, a nested call on this query gets an empty one
+                        std::vector<id> visiting = std::move(_visiting);
+
+                        visiting.assign(_entities.begin(), _entities.end());
+                        std::apply(
+                            [this, &world, deltaTime, &func, &ticks, &visiting](auto &...pools) {
+                                for (const auto entity : visiting) {
+                                    if (contains(entity)) {
+                                        world.template callFiltered<Terms...>(func, deltaTime, entity, ticks, pools...);
+                                    }
+                                }
+                            },
+                            std::tie(world.template getTermPool<Terms>()...));
+                        _visiting = std::move(visiting);
+                    }
+
+                    std::reference_wrapper<Core::World> _world;
+                    std::vector<id> _visiting;
+            };
+
 #pragma region constructors / destructors
             World() = default;
             ~World() = default;
 
-            World(const World &other) = default;
-            World &operator=(const World &other) = default;
+            /**
+             * @brief Construct a new World object
+             *
+             * @param aStorage The way the World stores its components
+             */
+            explicit World(WorldStorage aStorage);
 
-            World(World &&other) noexcept = default;
-            World &operator=(World &&other) noexcept = default;
+            World(const World &other) = delete;
+            World &operator=(const World &other) = delete;
+
+            // the cached queries, the systems and the tasks keep a reference to the World, App holds it by pointer
+            World(World &&other) noexcept = delete;
+            World &operator=(World &&other) noexcept = delete;
 #pragma endregion constructors / destructors
 
 #pragma region methods
 
-            template<typename... Components>
-            Query<Components...> query()
+            /**
+             * @brief Build a query on the entities matching a list of terms
+             *
+             * @tparam Terms The components, With / Without / Optional filters of the query
+             * @return Query<Terms...> The query, to iterate with forEach
+             */
+            template<typename... Terms>
+            Query<Terms...> query()
+            {
+                return Query<Terms...>(*this);
+            }
+
+            /**
+             * @brief Register a query in the World, or get it back if it is already registered
+             * @details The matching entities are found once by filtering the signatures of the entities, then the World
+             * updates the list on each structural change
+             * @throw WorldExceptionComponentNotRegistered if one of the components isn't registered
+             * @tparam Terms The components, With / Without / Optional filters of the query
+             * @return CachedQuery<Terms...>& The query, owned by the World
+             */
+            template<typename... Terms>
+            CachedQuery<Terms...> &registerQuery()
             {
-                return Query<Components...>(*this);
+                (checkRegistered<typename QueryTerm<Terms>::component>(), ...);
+                for (auto &query : _queries) {
+                    if (auto *cached = dynamic_cast<CachedQuery<Terms...> *>(query.get())) {
+                        return *cached;
+                    }
+                }
+                auto &cached = static_cast<CachedQuery<Terms...> &>(
+                    *_queries.emplace_back(std::make_unique<CachedQuery<Terms...>>(*this)));
+
+                indexQuery(cached);
+                if (!_archetypes) {
+                    for (const auto idx : filterEntities(cached.getMask())) {
+                        cached.refresh(idx, _signatures[idx]);
+                    }
+                }
+                return cached;
             }
 
             /**
              * @brief Add a component to the World
-             *
+             * @throw WorldExceptionTooManyComponents if the id of the component doesn't fit in a Signature
              * @tparam Component Type of the component
-             * @return SparseArray<Component>& Reference to the component SparseArray
+             * @param aStorage The memory layout of the component SparseArray, SparseSet suits the rare components
+             * @return SparseArray<Component>& Reference to the component SparseArray, left empty by a World using
+             * WorldStorage::Archetypes
              */
             template<typename Component>
-            SparseArray<Component> &registerComponent()
+            SparseArray<Component> &registerComponent(ComponentStorage aStorage = ComponentStorage::Dense)
             {
-                auto typeIndex = std::type_index(typeid(Component));
+                const auto componentId = ComponentRegistry::getId<Component>();
 
-                if (_components.find(typeIndex) != _components.end()) {
+                checkNoConcurrentSystem();
+                if (isRegistered(componentId)) {
                     throw WorldExceptionComponentAlreadyRegistered("Component already registered");
                 }
-                _components[typeIndex] = std::make_pair(SparseArray<Component>(),
-                                                        std::make_tuple(
-                                                            [](World &aWorld, const std::size_t &aIdx) {
-                                                                auto &myComponent = aWorld.getComponent<Component>();
+                if (componentId >= Signature::capacity) {
+                    throw WorldExceptionTooManyComponents("Too many component types, raise ZEPHYR_MAX_COMPONENTS");
+                }
+                if (_archetypes) {
+                    _archetypes->registerComponent<Component>();
+                }
+                if (componentId >= _components.size()) {
+                    _components.resize(componentId + 1);
+                }
+                auto array = std::make_unique<SparseArray<Component>>(aStorage);
+                auto &ref = *array;
+
+                array->setTickSource(_id, _tick.get());
+
+                _components[componentId] = std::move(array);
+                _registered.set(componentId);
+                return ref;
+            }
+
+            /**
+             * @brief Keep a snapshot of a component, read by the Snapshot<Component> query terms
+             * @details The snapshot is a copy of the SparseArray of the component taken at the end of each runSystems
+             * (see takeSnapshots), so the systems reading it see the components as they were at the end of the
+             * previous frame while the other systems write the current one. They don't conflict: the output systems
+             * (render, network) run alongside the simulation, provided they are in the same stage. The copy reuses
+             * the memory of the previous snapshot. The snapshot is taken once now.
+             * @throw WorldExceptionComponentNotRegistered if the component isn't registered
+             * @throw WorldExceptionWrongStorage if the World uses WorldStorage::Archetypes
+             * @tparam Component The type of the component
+             */
+            template<typename Component>
+            void enableSnapshot()
+            {
+                if (_archetypes) {
+                    throw WorldExceptionWrongStorage("Snapshots need the components in SparseArrays");
+                }
+                auto &live = getComponent<Component>();
+                const auto componentId = ComponentRegistry::getId<Component>();
+
+                if (componentId >= _snapshots.size()) {
+                    _snapshots.resize(componentId + 1);
+                    _snapshotCopies.resize(componentId + 1);
+                }
+                if (_snapshots[componentId]) {
+                    return;
+                }
+                auto snapshot = std::make_unique<SparseArray<Component>>(live);
+
+                _snapshotCopies[componentId] = [&live, &copy = *snapshot]() { copy = live; };
+                _snapshots[componentId] = std::move(snapshot);
+            }
 
-                                                                myComponent.init(aIdx);
-                                                            },
-                                                            [](World &aWorld, const std::size_t &aIdx) {
-                                                                auto &myComponent = aWorld.getComponent<Component>();
+            /**
+             * @brief Get the snapshot of a component
+             * @throw WorldExceptionNoSnapshot if enableSnapshot wasn't called for the component
+             * @tparam Component The type of the component
+             * @return const SparseArray<Component>& The components as they were at the last takeSnapshots
+             */
+            template<typename Component>
+            [[nodiscard]] const SparseArray<Component> &getSnapshot() const
+            {
+                const auto componentId = ComponentRegistry::getId<Component>();
 
-                                                                myComponent.erase(aIdx);
-                                                            }));
-                return std::any_cast<SparseArray<Component> &>(_components[typeIndex].first);
+                if (componentId >= _snapshots.size() || !_snapshots[componentId]) {
+                    throw WorldExceptionNoSnapshot("No snapshot of this component");
+                }
+                return static_cast<const SparseArray<Component> &>(*_snapshots[componentId]);
             }
 
             /**
              * @brief Add multiple components to the World
              *
              * @tparam Components The components to add
+             * @param aStorage The memory layout of the components SparseArrays
              */
             template<typename... Components>
-            void registerComponents()
+            void registerComponents(ComponentStorage aStorage = ComponentStorage::Dense)
             {
-                (registerComponent<Components>(), ...);
+                (registerComponent<Components>(aStorage), ...);
             }
 
             /**
              * @brief Get the Component object
-             *
+             * @details The pool only grows when a component is set, has() is false past its end. The components set or
+             * erased directly in the pool aren't seen by the signatures and the queries of the World, the structural
+             * changes go through addComponentToEntity / removeComponentFromEntity.
              * @tparam Component The type of the component
              * @return SparseArray<Component>& the SparseArray of the component
              */
             template<typename Component>
             SparseArray<Component> &getComponent()
             {
-                auto typeIndex = std::type_index(typeid(Component));
+                const auto componentId = ComponentRegistry::getId<Component>();
 
-                if (_components.find(typeIndex) == _components.end()) {
+                if (!isRegistered(componentId)) {
                     throw WorldExceptionComponentNotRegistered("Component not registered");
                 }
-                return std::any_cast<SparseArray<Component> &>(_components[typeIndex].first);
+                if (_archetypes) {
+                    throw WorldExceptionWrongStorage("Components of an archetype World aren't in SparseArrays");
+                }
+                return static_cast<SparseArray<Component> &>(*_components[componentId]);
             }
 
             /**
@@ -152,17 +533,21 @@ namespace Engine::Core {
             template<typename Component>
             SparseArray<Component> const &getComponent() const
             {
-                auto typeIndex = std::type_index(typeid(Component));
+                const auto componentId = ComponentRegistry::getId<Component>();
 
-                if (_components.find(typeIndex) == _components.end()) {
+                if (!isRegistered(componentId)) {
                     throw WorldExceptionComponentNotRegistered("Component not registered");
                 }
-                return std::any_cast<SparseArray<Component> const &>(_components.at(typeIndex).first);
+                if (_archetypes) {
+                    throw WorldExceptionWrongStorage("Components of an archetype World aren't in SparseArrays");
+                }
+                return static_cast<SparseArray<Component> const &>(*_components[componentId]);
             }
 
             /**
              * @brief Check if the entity has all the components
-             *
+             * @details Compare the signature of the entity with the mask of the components
+             * @throw WorldExceptionComponentNotRegistered if one of the components isn't registered
              * @tparam Components The components to check
              * @param aIndex The index of the entity
              * @return true if the entity has all the components
@@ -171,28 +556,105 @@ namespace Engine::Core {
             template<typename... Components>
             [[nodiscard]] bool hasComponents(std::size_t aIndex) const
             {
-                return (... && getComponent<Components>().has(aIndex));
+                if (_archetypes) {
+                    (checkRegistered<Components>(), ...);
+                    return _archetypes->has<Components...>(aIndex);
+                }
+                const Signature &mask = getMask<Components...>();
+
+                if (!_registered.contains(mask)) {
+                    throw WorldExceptionComponentNotRegistered("Component not registered");
+                }
+                return aIndex < _signatures.size() && _signatures[aIndex].contains(mask);
             }
 
             /**
-             * @brief Remove a component
+             * @brief Check if the entity has all the components
              *
+             * @tparam Components The components to check
+             * @param aEntity The handle of the entity
+             * @return false if the handle is stale or if the entity doesn't have all the components
+             */
+            template<typename... Components>
+            [[nodiscard]] bool hasComponents(Entity aEntity) const
+            {
+                return isAlive(aEntity) && hasComponents<Components...>(static_cast<std::size_t>(aEntity));
+            }
+
+            /**
+             * @brief Get a component of an entity, whatever the storage of the World
+             * @throw WorldExceptionComponentNotRegistered if the component isn't registered
+             * @tparam Component The type of the component
+             * @param aIndex The index of the entity
+             * @return Component& The component
+             */
+            template<typename Component>
+            Component &getEntityComponent(std::size_t aIndex)
+            {
+                if (_archetypes) {
+                    checkRegistered<Component>();
+                    return _archetypes->get<Component>(aIndex);
+                }
+                return getComponent<Component>().get(aIndex);
+            }
+
+            /**
+             * @brief Get a component of an entity, whatever the storage of the World
+             * @throw WorldExceptionStaleEntity if the handle is stale
+             * @tparam Component The type of the component
+             * @param aEntity The handle of the entity
+             * @return Component& The component
+             */
+            template<typename Component>
+            Component &getEntityComponent(Entity aEntity)
+            {
+                return getEntityComponent<Component>(checkAlive(aEntity));
+            }
+
+            /**
+             * @brief Remove a component
+             * @details The cached queries needing it are emptied, the ones excluding it get the entities it kept out.
+             * Its snapshot is dropped too, enableSnapshot has to be called again once it is registered back
              * @tparam Component The type of the component
              */
             template<typename Component>
             void removeComponent()
             {
-                auto typeIndex = std::type_index(typeid(Component));
+                const auto componentId = ComponentRegistry::getId<Component>();
 
-                if (_components.find(typeIndex) == _components.end()) {
+                checkNoConcurrentSystem();
+                if (!isRegistered(componentId)) {
                     throw WorldExceptionComponentNotRegistered("Component not registered");
                 }
-                _components.erase(typeIndex);
+                if (_archetypes) {
+                    _archetypes->removeComponent(componentId);
+                }
+                _components[componentId].reset();
+                if (componentId < _snapshots.size()) {
+                    _snapshots[componentId].reset();
+                    _snapshotCopies[componentId] = nullptr;
+                }
+                _registered.reset(componentId);
+                for (auto &signature : _signatures) {
+                    signature.reset(componentId);
+                }
+                if (componentId < _queriesByComponent.size()) {
+                    for (auto *query : _queriesByComponent[componentId]) {
+                        if (query->getMask().test(componentId)) {
+                            query->clear();
+                            continue;
+                        }
+                        // the queries excluding it now match the entities it kept out
+                        for (const auto idx : filterEntities(query->getMask())) {
+                            query->refresh(idx, _signatures[idx]);
+                        }
+                    }
+                }
             }
 
             /**
              * @brief Add a component to an entity
-             *
+             * @throw WorldExceptionStaleEntity if no entity lives at the index
              * @tparam Component The type of the component to add
              * @param aIndex The index of the entity
              * @param aComponent The component to add
@@ -201,19 +663,45 @@ namespace Engine::Core {
             template<typename Component>
             Component &addComponentToEntity(std::size_t aIndex, Component &&aComponent)
             {
+                checkNoConcurrentSystem();
+                if (!isAlive(aIndex)) {
+                    throw WorldExceptionStaleEntity("No live entity at index " + std::to_string(aIndex));
+                }
+                if (_archetypes) {
+                    checkRegistered<Component>();
+                    return _archetypes->emplace<Component>(aIndex, std::forward<Component>(aComponent));
+                }
                 try {
                     auto &component = getComponent<Component>();
 
-                    component.set(aIndex, std::forward<Component>(aComponent));
-                    return component.get(aIndex);
+                    // grown for every entity at once, so the returned reference lives until the next createEntity
+                    component.extend(_nextId);
+                    auto &added = component.emplace(aIndex, std::forward<Component>(aComponent));
+
+                    addToSignature(ComponentRegistry::getId<Component>(), aIndex);
+                    return added;
                 } catch (WorldExceptionComponentNotRegistered &e) {
                     throw WorldExceptionComponentNotRegistered("Component not registered");
                 }
             }
 
+            /**
+             * @brief Add a component to an entity
+             * @throw WorldExceptionStaleEntity if the handle is stale
+             * @tparam Component The type of the component to add
+             * @param aEntity The handle of the entity
+             * @param aComponent The component to add
+             * @return Component& The component added
+             */
+            template<typename Component>
+            Component &addComponentToEntity(Entity aEntity, Component &&aComponent)
+            {
+                return addComponentToEntity(checkAlive(aEntity), std::forward<Component>(aComponent));
+            }
+
             /**
              * @brief Build and add a component to an entity
-             *
+             * @throw WorldExceptionStaleEntity if no entity lives at the index
              * @tparam Component The type of the component to add
              * @tparam Args The types of the arguments to pass to the component constructor (infered)
              * @param aIndex The index of the entity
@@ -223,16 +711,75 @@ namespace Engine::Core {
             template<typename Component, typename... Args>
             Component &emplaceComponentToEntity(std::size_t aIndex, Args &&...aArgs)
             {
+                checkNoConcurrentSystem();
+                if (!isAlive(aIndex)) {
+                    throw WorldExceptionStaleEntity("No live entity at index " + std::to_string(aIndex));
+                }
+                if (_archetypes) {
+                    checkRegistered<Component>();
+                    return _archetypes->emplace<Component>(aIndex, std::forward<Args>(aArgs)...);
+                }
                 try {
                     auto &component = getComponent<Component>();
 
-                    component.emplace(aIndex, std::forward<Args>(aArgs)...);
-                    return component.get(aIndex);
+                    component.extend(_nextId);
+                    auto &added = component.emplace(aIndex, std::forward<Args>(aArgs)...);
+
+                    addToSignature(ComponentRegistry::getId<Component>(), aIndex);
+                    return added;
                 } catch (WorldExceptionComponentNotRegistered &e) {
                     throw WorldExceptionComponentNotRegistered("Component not registered");
                 }
             }
 
+            /**
+             * @brief Build and add a component to an entity
+             * @throw WorldExceptionStaleEntity if the handle is stale
+             * @tparam Component The type of the component to add
+             * @tparam Args The types of the arguments to pass to the component constructor (infered)
+             * @param aEntity The handle of the entity
+             * @param aArgs The arguments to pass to the component constructor
+             * @return Component& The component added
+             */
+            template<typename Component, typename... Args>
+            Component &emplaceComponentToEntity(Entity aEntity, Args &&...aArgs)
+            {
+                return emplaceComponentToEntity<Component>(checkAlive(aEntity), std::forward<Args>(aArgs)...);
+            }
+
+            /**
+             * @brief Build the same component on many entities
+             * @details The handles are all checked before anything is built, and the SparseArray is grown once
+             * @throw WorldExceptionStaleEntity if one of the handles is stale
+             * @tparam Component The type of the component to add
+             * @tparam Args The types of the arguments to pass to the component constructor (infered)
+             * @param aEntities The handles of the entities
+             * @param aArgs The arguments to pass to each component constructor, copied for each entity
+             */
+            template<typename Component, typename... Args>
+            void emplaceComponents(std::span<const Entity> aEntities, const Args &...aArgs)
+            {
+                checkNoConcurrentSystem();
+                for (const auto entity : aEntities) {
+                    static_cast<void>(checkAlive(entity));
+                }
+                if (_archetypes) {
+                    checkRegistered<Component>();
+                    for (const auto entity : aEntities) {
+                        _archetypes->emplace<Component>(entity.getIndex(), aArgs...);
+                    }
+                    return;
+                }
+                auto &component = getComponent<Component>();
+                const auto componentId = ComponentRegistry::getId<Component>();
+
+                component.extend(_nextId);
+                for (const auto entity : aEntities) {
+                    component.emplace(entity.getIndex(), aArgs...);
+                    addToSignature(componentId, entity.getIndex());
+                }
+            }
+
             /**
              * @brief Remove a component from an entity
              *
@@ -242,66 +789,338 @@ namespace Engine::Core {
             template<typename Component>
             void removeComponentFromEntity(std::size_t aIndex)
             {
+                checkNoConcurrentSystem();
+                if (_archetypes) {
+                    checkRegistered<Component>();
+                    _archetypes->remove<Component>(aIndex);
+                    return;
+                }
                 try {
                     auto &component = getComponent<Component>();
+                    const auto componentId = ComponentRegistry::getId<Component>();
 
-                    component.erase(aIndex);
+                    if (aIndex < _signatures.size() && _signatures[aIndex].test(componentId)) {
+                        component.erase(aIndex);
+                        _signatures[aIndex].reset(componentId);
+                        refreshQueries(componentId, aIndex);
+                    }
                 } catch (WorldExceptionComponentNotRegistered &e) {
                     throw WorldExceptionComponentNotRegistered("Component not registered");
                 }
             }
 
+            /**
+             * @brief Remove a component from an entity
+             * @throw WorldExceptionStaleEntity if the handle is stale
+             * @tparam Component The type of the component to remove
+             * @param aEntity The handle of the entity
+             */
+            template<typename Component>
+            void removeComponentFromEntity(Entity aEntity)
+            {
+                removeComponentFromEntity<Component>(checkAlive(aEntity));
+            }
+
             /**
              * @brief Kill an entity
-             * @details Call erase from each component on the entity, then add the id as a free id
+             * @details Call erase from each component in the signature of the entity, bump the generation of its index
+             * then push the index on the free list. Killing an index which isn't alive does nothing.
              * @param aIndex The index of the entity to kill
              */
             void killEntity(std::size_t aIndex);
 
+            /**
+             * @brief Kill an entity
+             * @throw WorldExceptionStaleEntity if the handle is stale
+             * @param aEntity The handle of the entity to kill
+             */
+            void killEntity(Entity aEntity);
+
             /**
              * @brief Create an entity
-             * @details Get the next free id, call init from each component on the entity, then return the id
-             * @return std::size_t The id of the entity
+             * @details Pop the last freed index (or take the next one) and return its handle, the entity starts with
+             * an empty signature
+             * @return Entity The handle of the entity, it converts to the index of the entity
              */
-            std::size_t createEntity();
+            Entity createEntity();
 
             /**
-             * @brief Add a system to the world
+             * @brief Create many entities at once
+             * @details The freed indexes are reused first, the rest is one contiguous range of new indexes for which
+             * the entity tables are grown once
+             * @param aCount The number of entities to create
+             * @return std::vector<Entity> The handles of the entities
+             */
+            std::vector<Entity> createEntities(std::size_t aCount);
+
+            /**
+             * @brief Kill many entities at once
+             * @details The handles are all checked before any entity is killed
+             * @throw WorldExceptionStaleEntity if one of the handles is stale
+             * @param aEntities The handles of the entities to kill
+             */
+            void killEntities(std::span<const Entity> aEntities);
+
+            /**
+             * @brief Check if a handle still designates a live entity
+             *
+             * @param aEntity The handle of the entity
+             * @return false if the entity was killed since the handle was made
+             */
+            [[nodiscard]] bool isAlive(Entity aEntity) const;
+
+            /**
+             * @brief Check if an index is used by a live entity
              *
-             * @tparam Components The components the system will use
-             * @tparam Function The type of the system (infered)
-             * @param aFunction The system to add
+             * @param aIndex The index of the entity
+             * @return true if the index is used
+             */
+            [[nodiscard]] bool isAlive(std::size_t aIndex) const;
+
+            /**
+             * @brief Get the handle of the live entity using an index
+             * @throw WorldExceptionStaleEntity if the index isn't used
+             * @param aIndex The index of the entity, as given to the query callbacks
+             * @return Entity The handle of the entity
+             */
+            [[nodiscard]] Entity getEntity(std::size_t aIndex) const;
+
+            /**
+             * @brief Get the live entities owning every component of a mask
+             * @details The signatures of all the entities are filtered in one pass, see Signature::filter
+             * @param aMask The required components, an empty mask matches every live entity
+             * @param aExclude The components the entities must not own
+             * @return std::vector<std::size_t> The indexes of the entities, in ascending order
+             */
+            [[nodiscard]] std::vector<std::size_t> filterEntities(const Signature &aMask,
+                                                                  const Signature &aExclude = Signature()) const;
+
+            /**
+             * @brief Get the mask of a set of components
+             * @throw WorldExceptionComponentNotRegistered if a component id doesn't fit in a Signature, such a
+             * component can't be registered
+             * @tparam Components The components of the mask
+             * @return const Signature& The mask, built once per set of components
+             */
+            template<typename... Components>
+            [[nodiscard]] static const Signature &getMask()
+            {
+                return getQueryMasks<Components...>().include;
+            }
+
+            /**
+             * @brief Get the masks of the terms of a query
+             * @throw WorldExceptionComponentNotRegistered if a component id doesn't fit in a Signature, such a
+             * component can't be registered
+             * @tparam Terms The components, With / Without / Optional filters of the query
+             * @return const QueryMasks& The required and excluded components, built once per list of terms
+             */
+            template<typename... Terms>
+            [[nodiscard]] static const QueryMasks &getQueryMasks()
+            {
+                static const QueryMasks masks = [] {
+                    QueryMasks result;
+                    [[maybe_unused]] auto add = [&result](std::size_t aId, bool aRequired, bool aExcluded) {
+                        if (aId >= Signature::capacity) {
+                            throw WorldExceptionComponentNotRegistered("Component not registered");
+                        }
+                        if (aRequired) {
+                            result.include.set(aId);
+                        }
+                        if (aExcluded) {
+                            result.exclude.set(aId);
+                        }
+                    };
+
+                    (add(ComponentRegistry::getId<typename QueryTerm<Terms>::component>(), QueryTerm<Terms>::required,
+                         QueryTerm<Terms>::excluded),
+                     ...);
+                    return result;
+                }();
+
+                return masks;
+            }
+
+            /**
+             * @brief Get the components read and written by the terms of a query
+             * @throw WorldExceptionComponentNotRegistered if a component id doesn't fit in a Signature
+             * @tparam Terms The terms of the query, const components being only read
+             * @return const QueryAccess& The read and written components, built once per list of terms
+             */
+            template<typename... Terms>
+            [[nodiscard]] static const QueryAccess &getQueryAccess()
+            {
+                static const QueryAccess access = [] {
+                    QueryAccess result;
+                    [[maybe_unused]] auto add = [&result](std::size_t aId, bool aAccessed, bool aReadOnly) {
+                        if (aId >= Signature::capacity) {
+                            throw WorldExceptionComponentNotRegistered("Component not registered");
+                        }
+                        if (aAccessed) {
+                            (aReadOnly ? result.reads : result.writes).set(aId);
+                        }
+                    };
+
+                    (add(ComponentRegistry::getId<typename QueryTerm<Terms>::component>(), QueryTerm<Terms>::accessed,
+                         QueryTerm<Terms>::readOnly),
+                     ...);
+                    return result;
+                }();
+
+                return access;
+            }
+
+            /**
+             * @brief Add a system to the world
+             * @details The system runs after the systems already in its stage, unless its constraints or the ones of
+             * the other systems say otherwise
+             * @throw WorldExceptionSystemAlreadyRegistered if a system has the same name
+             * @param aSystem The name and the system to add
+             * @param aStage The stage the system runs in
              */
-            void addSystem(newSystemFunc &aSystem)
+            void addSystem(newSystemFunc &aSystem, Stage aStage = Stage::Update)
             {
-                if (_systems.find(aSystem.first) != _systems.end()) {
+                if (!_systemStages.emplace(aSystem.first, aStage).second) {
                     throw WorldExceptionSystemAlreadyRegistered("System already registered");
                 }
 
-                _systems[aSystem.first] = std::move(aSystem.second);
+                _systems[static_cast<std::size_t>(aStage)].emplace_back(aSystem.first, std::move(aSystem.second));
+                _systemsChanged = true;
             }
 
             /**
              * @brief Remove a system from the world
-             *
-             * @tparam Function The type of the system (infered)
-             * @param aFunction The system to remove
+             * @throw WorldExceptionSystemNotRegistered if no system has this name
+             * @param aFuncName The name of the system to remove
              */
             void removeSystem(std::string &aFuncName)
             {
-                if (_systems.find(aFuncName) == _systems.end()) {
+                const auto found = _systemStages.find(aFuncName);
+
+                if (found == _systemStages.end()) {
                     throw WorldExceptionSystemNotRegistered("System not registered");
                 }
 
-                _systems.erase(aFuncName);
+                auto &stage = _systems[static_cast<std::size_t>(found->second)];
+
+                stage.erase(std::find_if(stage.begin(), stage.end(), [&aFuncName](const newSystemFunc &aSystem) {
+                    return aSystem.first == aFuncName;
+                }));
+                _systemStages.erase(found);
+                _systemsChanged = true;
             }
 
             /**
-             * @brief Run all the systems once
-             *
+             * @brief Get a system of the world
+             * @throw WorldExceptionSystemNotRegistered if no system has this name
+             * @param aName The name of the system
+             * @return System& The system
+             */
+            [[nodiscard]] System &getSystem(const std::string &aName);
+
+            /**
+             * @brief Activate or deactivate a system
+             * @details A deactivated system is skipped by runSystems: it isn't prepared, doesn't run its query and
+             * doesn't accumulate time. The graph isn't rebuilt.
+             * @throw WorldExceptionSystemNotRegistered if no system has this name
+             * @param aName The name of the system
+             * @param aActive true to run the system
+             */
+            void setSystemActive(const std::string &aName, bool aActive);
+
+            /**
+             * @brief Run a frame of the systems, timed by the clock of the World
+             * @details The time of the frame is the time since the previous call (since the World was built for the
+             * first one), see runSystems(double)
+             * @throw SystemSchedulerException if the ordering constraints of the systems can't be met
              */
             void runSystems();
 
+            /**
+             * @brief Run a frame of the systems
+             * @details The events pushed since the last frame are drained first (see EventManager::drainEvents), then
+             * the tasks whose wait is over are resumed, on the calling thread (see startTask). The stages run one after
+             * the other. The active systems are prepared one after the other, then run on the shared JobSystem: the
+             * systems with declared access run alongside the ones of their stage they don't conflict with, see
+             * SystemScheduler. While a system with declared access runs, the structural changes throw
+             * WorldExceptionSystemsRunning, they go through getCommandBuffer. The graph is rebuilt when a system is
+             * added or removed. The systems without tick rate run once with aElapsed as deltaTime, the other ones as
+             * many fixed steps as the time accumulated allows (see System::setTickRate). The commands recorded by the
+             * systems are replayed once every system is done (see flushCommands), then the snapshots are taken (see
+             * enableSnapshot) and the event channels of the World are swapped (see getEventManager).
+             * @throw SystemSchedulerException if the ordering constraints of the systems can't be met
+             * @throw The first exception thrown by a task, the systems don't run this frame
+             * @param aElapsed The time of the frame in milliseconds
+             */
+            void runSystems(double aElapsed);
+
+            /**
+             * @brief Get the interpolation factor between the last two steps of the fastest fixed rate system
+             * @details Given to the variable rate systems with their deltaTime, to render between two physics steps
+             * @return double The factor of the last frame, in [0, 1)
+             */
+            [[nodiscard]] double getAlpha() const;
+
+            /**
+             * @brief Get the command buffer of the calling thread
+             * @details Each thread records in its own buffer, so the systems and the parallel queries can record
+             * structural changes without locking. The buffers are replayed by flushCommands.
+             * @return CommandBuffer& The buffer of the thread for this World
+             */
+            [[nodiscard]] CommandBuffer &getCommandBuffer();
+
+            /**
+             * @brief Replay the commands recorded in the buffers of every thread, see CommandBuffer
+             * @details The sync point of the structural changes, done at the end of runSystems. No thread may record
+             * meanwhile.
+             */
+            void flushCommands();
+
+            /**
+             * @brief Start a coroutine, which runs at the start of the next runSystems
+             * @details The task then runs over the frames, resumed by runSystems before the systems whenever the
+             * awaitable it co_awaits from getTasks is ready, see TaskScheduler. It can be started from a system.
+             * @throw TaskException if the task was already started
+             * @param aTask The task, built by calling a coroutine returning Task
+             */
+            void startTask(Task aTask);
+
+            /**
+             * @brief Get the suspended tasks of the World, and the awaitables of the tasks
+             *
+             * @return TaskScheduler& The tasks
+             */
+            [[nodiscard]] TaskScheduler &getTasks();
+
+            /**
+             * @brief Get the events of the World
+             * @details The worlds don't share their events, so they can run in parallel (see App::runAll). The tasks
+             * of the World wait for these events, and its event channels are swapped at the end of runSystems.
+             * @return Engine::Event::EventManager& The EventManager of the World
+             */
+            [[nodiscard]] Engine::Event::EventManager &getEventManager();
+
+            /**
+             * @brief Get the ticks the queries of the calling thread compare the change ticks against
+             * @details Inside a system run by runSystems: the tick of its previous run and the one of this run. Outside
+             * of the systems: every change up to now counts, the last run tick being 0.
+             * @return ChangeTicks The ticks, see Added and Changed
+             */
+            [[nodiscard]] ChangeTicks getChangeTicks() const;
+
+            /**
+             * @brief Copy the components with a snapshot in their snapshots, one job per component
+             * @details Done at the end of runSystems, once the commands are replayed. No system may run meanwhile.
+             */
+            void takeSnapshots();
+
+            /**
+             * @brief Get the dependency graph of the systems, as built by the last runSystems
+             *
+             * @return const SystemScheduler& The graph
+             */
+            [[nodiscard]] const SystemScheduler &getSystemScheduler() const;
+
             /**
              * @brief Get the Current Id object
              *
@@ -309,30 +1128,276 @@ namespace Engine::Core {
              */
             [[nodiscard]] std::size_t getCurrentId() const;
 
+            /**
+             * @brief Get the way the World stores its components
+             *
+             * @return WorldStorage The storage of the World
+             */
+            [[nodiscard]] WorldStorage getStorage() const;
+
         protected:
             /**
-             * @brief Get the Init Func used to init the component
+             * @brief Check if a live entity matches the masks of a query
+             *
+             * @param aIndex The index of the entity
+             * @param aMasks The masks of the query
+             * @return true if the entity owns every required component and no excluded one
+             */
+            [[nodiscard]] bool matches(std::size_t aIndex, const QueryMasks &aMasks) const
+            {
+                if (!isAlive(aIndex)) {
+                    return false;
+                }
+                const Signature &signature = _signatures[aIndex];
+
+                return signature.contains(aMasks.include) && !signature.intersects(aMasks.exclude);
+            }
+
+            /**
+             * @brief Call a query callback with the fetched terms of an entity
+             *
+             * @param aFunc The callback
+             * @param aDeltaTime The time given to the callback
+             * @param aIndex The index of the entity
+             * @param aArgs The tuple of the components given to the callback
+             */
+            template<typename Func, typename Tuple>
+            void call(Func &aFunc, double aDeltaTime, std::size_t aIndex, Tuple &&aArgs)
+            {
+                std::apply(
+                    [this, &aFunc, aDeltaTime, aIndex](auto &&...args) { aFunc(*this, aDeltaTime, aIndex, args...); },
+                    std::forward<Tuple>(aArgs));
+            }
+
+            /**
+             * @brief Call a query callback on a matching entity if it passes the change terms
+             * @details The components given as mutable are marked as changed at the tick of the run
+             * @tparam Terms The terms of the query
+             * @param aFunc The callback
+             * @param aDeltaTime The time given to the callback
+             * @param aIndex The index of the entity, matching the masks of the terms
+             * @param aTicks The ticks of the run, see getChangeTicks
+             * @param aPools The SparseArray of each term
+             */
+            template<typename... Terms, typename Func, typename... Pools>
+            void callFiltered(Func &aFunc, double aDeltaTime, std::size_t aIndex, const ChangeTicks &aTicks,
+                              Pools &...aPools)
+            {
+                if ((QueryTerm<Terms>::accepts(aPools, aIndex, aTicks) && ...)) {
+                    (QueryTerm<Terms>::touch(aPools, aIndex, aTicks.thisRun), ...);
+                    call(aFunc, aDeltaTime, aIndex, std::tuple_cat(QueryTerm<Terms>::fetch(aPools, aIndex)...));
+                }
+            }
+
+            /**
+             * @brief Throw if a query needs change ticks or snapshots, the archetypes keep neither
+             * @throw WorldExceptionWrongStorage if one of the terms is Added / Changed / Snapshot
+             * @tparam Terms The terms of the query
+             */
+            template<typename... Terms>
+            static void checkArchetypeTerms()
+            {
+                if constexpr (((QueryTerm<Terms>::tracked || QueryTerm<Terms>::snapshot) || ...)) {
+                    throw WorldExceptionWrongStorage("Added / Changed / Snapshot need the components in SparseArrays");
+                }
+            }
+
+            /**
+             * @brief Get the SparseArray a query term is fetched from
+             * @throw WorldExceptionComponentNotRegistered if the component isn't registered
+             * @throw WorldExceptionNoSnapshot if the term is a Snapshot of a component without snapshot
+             * @tparam Term The term
+             * @return SparseArray& The SparseArray of the component, or its snapshot
+             */
+            template<typename Term>
+            SparseArray<typename QueryTerm<Term>::component> &getTermPool()
+            {
+                using component = typename QueryTerm<Term>::component;
+
+                if constexpr (QueryTerm<Term>::snapshot) {
+                    const auto componentId = ComponentRegistry::getId<component>();
+
+                    if (componentId >= _snapshots.size() || !_snapshots[componentId]) {
+                        throw WorldExceptionNoSnapshot("No snapshot of this component");
+                    }
+                    return static_cast<SparseArray<component> &>(*_snapshots[componentId]);
+                } else {
+                    return getComponent<component>();
+                }
+            }
+
+            /**
+             * @brief Call a query callback on every row of an archetype chunk
+             *
+             * @tparam Terms The terms of the query, the archetype matching them
+             * @param aDeltaTime The time given to the callback
+             * @param aFunc The callback
+             * @param aArchetype The archetype
+             * @param aChunk The index of the chunk in the archetype
+             */
+            template<typename... Terms, typename Func>
+            void runChunk(double aDeltaTime, Func &aFunc, Archetype &aArchetype, std::size_t aChunk)
+            {
+                const std::size_t count = aArchetype.getChunkSize(aChunk);
+                const std::size_t *entities = aArchetype.getEntities(aChunk);
+
+                std::apply(
+                    [this, aDeltaTime, &aFunc, count, entities](auto *...columns) {
+                        for (std::size_t row = 0; row < count; row++) {
+                            call(aFunc, aDeltaTime, entities[row],
+                                 std::tuple_cat(QueryTerm<Terms>::fetch(columns, row)...));
+                        }
+                    },
+                    std::make_tuple(QueryTerm<Terms>::column(
+                        aArchetype, aChunk, ComponentRegistry::getId<typename QueryTerm<Terms>::component>())...));
+            }
+
+            /**
+             * @brief Call a query callback on a list of matching entities, split in ranges run on a job system
+             *
+             * @tparam Terms The terms of the query, every entity of the list matching them
+             * @param aDeltaTime The time given to the callback
+             * @param aFunc The callback, shared by the threads
+             * @param aEntities The indexes of the entities
+             * @param aGrain The number of entities of a range
+             * @param aJobs The job system to run the ranges on
+             */
+            template<typename... Terms, typename Func>
+            void runParallel(double aDeltaTime, Func &aFunc, std::span<const std::size_t> aEntities, std::size_t aGrain,
+                             JobSystem &aJobs)
+            {
+                // taken on the calling thread, the workers don't run the system
+                const ChangeTicks ticks = getChangeTicks();
+
+                std::apply(
+                    [this, aDeltaTime, &aFunc, aEntities, aGrain, &aJobs, &ticks](auto &...pools) {
+                        aJobs.parallelFor(aEntities.size(), aGrain,
+                                          [this, aDeltaTime, &aFunc, aEntities, &ticks,
+                                           &pools...](std::size_t aBegin, std::size_t aEnd) {
+                                              for (const auto idx : aEntities.subspan(aBegin, aEnd - aBegin)) {
+                                                  callFiltered<Terms...>(aFunc, aDeltaTime, idx, ticks, pools...);
+                                              }
+                                          });
+                    },
+                    std::tie(getTermPool<Terms>()...));
+            }
+
+            /**
+             * @brief Get the index of a handle
+             * @throw WorldExceptionStaleEntity if the handle is stale
+             * @param aEntity The handle of the entity
+             * @return std::size_t The index of the entity
+             */
+            [[nodiscard]] std::size_t checkAlive(Entity aEntity) const;
+
+            /**
+             * @brief Take new indexes at the end of the entity tables
+             * @throw WorldException if the indexes wouldn't fit in an Entity
+             * @param aCount The number of indexes
+             */
+            void growEntities(std::size_t aCount);
+
+            /**
+             * @brief Make a live index known to the storage and to the queries matching every entity
+             *
+             * @param aIndex The index of the entity, already marked alive
+             * @return Entity The handle of the entity
+             */
+            Entity spawnEntity(std::size_t aIndex);
+
+            /**
+             * @brief Release the components and the index of a live entity
+             *
+             * @param aIndex The index of the entity
+             */
+            void destroyEntity(std::size_t aIndex);
+
+            /**
+             * @brief Set a component in the signature of an entity and refresh the queries depending on it
+             *
+             * @param aComponentId The id of the component, from the ComponentRegistry
+             * @param aIndex The index of the entity
+             */
+            void addToSignature(std::size_t aComponentId, std::size_t aIndex);
+
+            /**
+             * @brief Re-evaluate an entity in the registered queries depending on a component
+             *
+             * @param aComponentId The id of the component added to or removed from the entity
+             * @param aIndex The index of the entity
+             */
+            void refreshQueries(std::size_t aComponentId, std::size_t aIndex);
+
+            /**
+             * @brief Link a new query to the components it depends on
              *
-             * @param aTypeIndex The type index of the component
-             * @return containerFunc The init function
+             * @param aQuery The query
+             */
+            void indexQuery(QueryCache &aQuery);
+
+            /**
+             * @brief Throw if a component isn't registered
+             * @throw WorldExceptionComponentNotRegistered if the component isn't registered
+             * @tparam Component The type of the component
              */
-            containerFunc getInitFunc(std::type_index aTypeIndex)
+            template<typename Component>
+            void checkRegistered() const
             {
-                return std::get<0>(_components[aTypeIndex].second);
+                if (!isRegistered(ComponentRegistry::getId<Component>())) {
+                    throw WorldExceptionComponentNotRegistered("Component not registered");
+                }
             }
 
             /**
-             * @brief Get the Erase Func used to erase the component
+             * @brief Check if a component id has a pool in this World
              *
-             * @param aTypeIndex The type index of the component
-             * @return containerFunc The erase function
+             * @param aComponentId The id of the component, from the ComponentRegistry
+             * @return true if the component is registered
              */
-            containerFunc getEraseFunc(std::type_index aTypeIndex)
+            [[nodiscard]] bool isRegistered(std::size_t aComponentId) const
             {
-                return std::get<1>(_components[aTypeIndex].second);
+                return aComponentId < _components.size() && _components[aComponentId] != nullptr;
             }
+
+            /**
+             * @brief Throw if a system with declared access runs, the structural changes racing with it
+             * @throw WorldExceptionSystemsRunning if one runs
+             */
+            void checkNoConcurrentSystem() const;
+
+            /**
+             * @brief Get a new id for a World, never given twice in the process
+             */
+            static std::size_t takeId();
 #pragma endregion methods
     };
+
+    template<typename Component>
+    void CommandBuffer::ComponentCommands<Component>::apply(World &aWorld)
+    {
+        // stable, so the commands of an entity stay in the order they were recorded
+        std::stable_sort(commands.begin(), commands.end(), [](const auto &aLeft, const auto &aRight) {
+            return aLeft.first.entity.getIndex() < aRight.first.entity.getIndex();
+        });
+        for (std::size_t idx = 0; idx < commands.size(); idx++) {
+            auto &[target, component] = commands[idx];
+
+            // only the last command recorded for an entity is applied
+            if (idx + 1 < commands.size() && commands[idx + 1].first.entity == target.entity) {
+                continue;
+            }
+            if (!aWorld.isAlive(target.entity)) {
+                continue;
+            }
+            const std::size_t index = target.entity.getIndex();
+
+            if (component) {
+                aWorld.addComponentToEntity(index, std::move(*component));
+            } else if (aWorld.template hasComponents<Component>(index)) {
+                aWorld.template removeComponentFromEntity<Component>(index);
+            }
+        }
+    }
 } // namespace Engine::Core
 
 #endif /* !WORLD_HPP_ */
@@ -0,0 +1,215 @@
+#include "Archetype.hpp"
+#include <algorithm>
+#include <string>
+
+namespace Engine::Core {
+    Archetype::Archetype(const Signature &aSignature, const std::vector<ComponentInfo> &aInfos)
+        : _signature(aSignature),
+          _infos(aInfos),
+          _offsets(aInfos.size(), npos)
+    {
+        std::size_t rowBytes = sizeof(id);
+
+        _signature.forEach([this, &rowBytes](std::size_t aBit) {
+            _components.push_back(aBit);
+            rowBytes += _infos[aBit].size;
+        });
+        _capacity = std::max<std::size_t>(chunkSize / rowBytes, 1);
+        while (_capacity > 1 && computeLayout(_capacity) > chunkSize) {
+            _capacity--;
+        }
+        _bytes = std::max(chunkSize, computeLayout(_capacity));
+    }
+
+    Archetype::~Archetype()
+    {
+        for (std::size_t chunk = 0; chunk < _chunks.size(); chunk++) {
+            for (std::size_t row = 0; row < _chunks[chunk].count; row++) {
+                destroyRow(chunk, row);
+            }
+        }
+    }
+
+    std::size_t Archetype::computeLayout(std::size_t aCapacity)
+    {
+        std::size_t offset = sizeof(id) * aCapacity;
+
+        for (const auto bit : _components) {
+            const auto &info = _infos[bit];
+
+            offset = (offset + info.align - 1) / info.align * info.align;
+            _offsets[bit] = offset;
+            offset += info.size * aCapacity;
+        }
+        return offset;
+    }
+
+    std::pair<std::size_t, std::size_t> Archetype::allocateRow(id aEntity)
+    {
+        if (_chunks.empty() || _chunks.back().count == _capacity) {
+            _chunks.push_back(
+                Chunk {std::unique_ptr<std::byte, ChunkDeleter>(
+                           static_cast<std::byte *>(::operator new(_bytes, std::align_val_t {chunkAlign}))),
+                       0});
+        }
+        const std::size_t chunk = _chunks.size() - 1;
+        const std::size_t row = _chunks[chunk].count++;
+
+        getEntities(chunk)[row] = aEntity;
+        return {chunk, row};
+    }
+
+    Archetype::id Archetype::removeRow(std::size_t aChunk, std::size_t aRow)
+    {
+        const std::size_t lastChunk = _chunks.size() - 1;
+        const std::size_t lastRow = _chunks[lastChunk].count - 1;
+        id moved = npos;
+
+        if (aChunk != lastChunk || aRow != lastRow) {
+            for (const auto bit : _components) {
+                _infos[bit].relocate(getComponent(aChunk, aRow, bit), getComponent(lastChunk, lastRow, bit));
+            }
+            moved = getEntities(lastChunk)[lastRow];
+            getEntities(aChunk)[aRow] = moved;
+        }
+        if (--_chunks[lastChunk].count == 0) {
+            _chunks.pop_back();
+        }
+        return moved;
+    }
+
+    void Archetype::destroyRow(std::size_t aChunk, std::size_t aRow)
+    {
+        for (const auto bit : _components) {
+            _infos[bit].destroy(getComponent(aChunk, aRow, bit));
+        }
+    }
+
+    Archetype *Archetype::getEdge(std::size_t aBit, bool aAdd) const
+    {
+        const auto &edges = aAdd ? _addEdges : _removeEdges;
+        auto found = edges.find(aBit);
+
+        return found == edges.end() ? nullptr : found->second;
+    }
+
+    void Archetype::setEdge(std::size_t aBit, bool aAdd, Archetype *aArchetype)
+    {
+        auto &edges = aAdd ? _addEdges : _removeEdges;
+
+        edges[aBit] = aArchetype;
+    }
+
+    ArchetypeStorage::ArchetypeStorage()
+    {
+        getArchetype(Signature());
+    }
+
+    void ArchetypeStorage::createEntity(id aEntity)
+    {
+        if (aEntity >= _locations.size()) {
+            _locations.resize(aEntity + 1);
+        }
+        auto &root = getArchetype(Signature());
+        const auto [chunk, row] = root.allocateRow(aEntity);
+
+        _locations[aEntity] = EntityLocation {&root, chunk, row};
+    }
+
+    void ArchetypeStorage::killEntity(id aEntity)
+    {
+        if (aEntity >= _locations.size() || _locations[aEntity].archetype == nullptr) {
+            return;
+        }
+        const EntityLocation location = _locations[aEntity];
+
+        location.archetype->destroyRow(location.chunk, location.row);
+        releaseRow(location);
+        _locations[aEntity] = EntityLocation {};
+    }
+
+    void ArchetypeStorage::removeComponent(std::size_t aBit)
+    {
+        for (std::size_t idx = 0; idx < _archetypes.size(); idx++) {
+            auto &archetype = *_archetypes[idx];
+
+            if (!archetype.getSignature().test(aBit)) {
+                continue;
+            }
+            while (archetype.size() > 0) {
+                const std::size_t lastChunk = archetype.getChunkCount() - 1;
+                const id entity = archetype.getEntities(lastChunk)[archetype.getChunkSize(lastChunk) - 1];
+
+                moveEntity(entity, getNeighbour(archetype, aBit, false));
+            }
+        }
+    }
+
+    ArchetypeStorage::EntityLocation &ArchetypeStorage::getLocation(id aEntity)
+    {
+        if (aEntity >= _locations.size() || _locations[aEntity].archetype == nullptr) {
+            throw ArchetypeExceptionUnknownEntity("Entity not alive: " + std::to_string(aEntity));
+        }
+        return _locations[aEntity];
+    }
+
+    Archetype &ArchetypeStorage::getNeighbour(Archetype &aFrom, std::size_t aBit, bool aAdd)
+    {
+        if (auto *edge = aFrom.getEdge(aBit, aAdd)) {
+            return *edge;
+        }
+        Signature signature = aFrom.getSignature();
+
+        if (aAdd) {
+            signature.set(aBit);
+        } else {
+            signature.reset(aBit);
+        }
+        auto &neighbour = getArchetype(signature);
+
+        aFrom.setEdge(aBit, aAdd, &neighbour);
+        neighbour.setEdge(aBit, !aAdd, &aFrom);
+        return neighbour;
+    }
+
+    Archetype &ArchetypeStorage::getArchetype(const Signature &aSignature)
+    {
+        auto found = _archetypesBySignature.find(aSignature);
+
+        if (found != _archetypesBySignature.end()) {
+            return *found->second;
+        }
+        auto &archetype = _archetypes.emplace_back(std::make_unique<Archetype>(aSignature, _infos));
+
+        _archetypesBySignature[aSignature] = archetype.get();
+        return *archetype;
+    }
+
+    void ArchetypeStorage::moveEntity(id aEntity, Archetype &aTo)
+    {
+        const EntityLocation from = _locations[aEntity];
+        const auto [chunk, row] = aTo.allocateRow(aEntity);
+
+        from.archetype->getSignature().forEach([&](std::size_t aBit) {
+            void *src = from.archetype->getComponent(from.chunk, from.row, aBit);
+
+            if (aTo.getSignature().test(aBit)) {
+                _infos[aBit].relocate(aTo.getComponent(chunk, row, aBit), src);
+            } else {
+                _infos[aBit].destroy(src);
+            }
+        });
+        releaseRow(from);
+        _locations[aEntity] = EntityLocation {&aTo, chunk, row};
+    }
+
+    void ArchetypeStorage::releaseRow(const EntityLocation &aLocation)
+    {
+        const id moved = aLocation.archetype->removeRow(aLocation.chunk, aLocation.row);
+
+        if (moved != Archetype::npos) {
+            _locations[moved].chunk = aLocation.chunk;
+            _locations[moved].row = aLocation.row;
+        }
+    }
+} // namespace Engine::Core
@@ -0,0 +1,28 @@
+#include "ChangeTicks.hpp"
+
+namespace Engine::Core {
+    namespace {
+        ChangeTicks &current()
+        {
+            thread_local ChangeTicks ticks;
+
+            return ticks;
+        }
+    } // namespace
+
+    const ChangeTicks &ChangeTicks::getCurrent()
+    {
+        return current();
+    }
+
+    ChangeTicks::Scope::Scope(const ChangeTicks &aTicks)
+        : _previous(current())
+    {
+        current() = aTicks;
+    }
+
+    ChangeTicks::Scope::~Scope()
+    {
+        current() = _previous;
+    }
+} // namespace Engine::Core
@@ -0,0 +1,73 @@
+#include "CommandBuffer.hpp"
+#include <algorithm>
+#include <utility>
+#include "World.hpp"
+
+namespace Engine::Core {
+    CommandBuffer::PendingEntity CommandBuffer::createEntity()
+    {
+        return PendingEntity {_pending++};
+    }
+
+    void CommandBuffer::killEntity(Entity aEntity)
+    {
+        _killed.push_back(aEntity);
+    }
+
+    bool CommandBuffer::empty() const
+    {
+        return _pending == 0 && _killed.empty()
+            && std::all_of(_commands.begin(), _commands.end(),
+                           [](const std::unique_ptr<Commands> &aCommands) { return !aCommands || aCommands->empty(); });
+    }
+
+    void CommandBuffer::clear()
+    {
+        for (auto &commands : _commands) {
+            if (commands) {
+                commands->clear();
+            }
+        }
+        _pending = 0;
+        _killed.clear();
+    }
+
+    void CommandBuffer::submit(World &aWorld, CommandBuffer &aOther)
+    {
+        if (_pending > 0) {
+            const auto created = aWorld.createEntities(_pending);
+
+            for (auto &commands : _commands) {
+                if (commands) {
+                    commands->resolve(created);
+                }
+            }
+            _pending = 0;
+        }
+        for (auto &commands : _commands) {
+            if (commands && !commands->empty()) {
+                commands->moveInto(aOther);
+            }
+        }
+        aOther._killed.insert(aOther._killed.end(), _killed.begin(), _killed.end());
+        _killed.clear();
+    }
+
+    void CommandBuffer::apply(World &aWorld)
+    {
+        for (auto &commands : _commands) {
+            if (commands && !commands->empty()) {
+                commands->apply(aWorld);
+                commands->clear();
+            }
+        }
+        std::sort(_killed.begin(), _killed.end(), [](Entity aLeft, Entity aRight) {
+            return std::pair(aLeft.getIndex(), aLeft.getGeneration())
+                < std::pair(aRight.getIndex(), aRight.getGeneration());
+        });
+        _killed.erase(std::unique(_killed.begin(), _killed.end()), _killed.end());
+        std::erase_if(_killed, [&aWorld](Entity aEntity) { return !aWorld.isAlive(aEntity); });
+        aWorld.killEntities(_killed);
+        _killed.clear();
+    }
+} // namespace Engine::Core
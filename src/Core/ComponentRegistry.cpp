@@ -0,0 +1,34 @@
+#include "ComponentRegistry.hpp"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace Engine::Core {
+    namespace {
+        std::atomic<std::size_t> componentCount {0};
+        std::mutex componentIdsMutex;
+
+        std::unordered_map<std::type_index, std::size_t> &componentIds()
+        {
+            static std::unordered_map<std::type_index, std::size_t> ids;
+
+            return ids;
+        }
+    } // namespace
+
+    std::size_t ComponentRegistry::getId(std::type_index aType)
+    {
+        const std::lock_guard lock(componentIdsMutex);
+        const auto [entry, added] = componentIds().try_emplace(aType, componentCount.load(std::memory_order_relaxed));
+
+        if (added) {
+            componentCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        return entry->second;
+    }
+
+    std::size_t ComponentRegistry::getCount()
+    {
+        return componentCount.load(std::memory_order_relaxed);
+    }
+} // namespace Engine::Core
@@ -1,7 +1,22 @@
 #include "Events/EventsManager.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    std::mutex eventIdsMutex;
+
+    std::unordered_map<std::type_index, std::size_t> &eventIds()
+    {
+        static std::unordered_map<std::type_index, std::size_t> ids;
+
+        return ids;
+    }
+} // namespace
 
 //-------------------CONSTRUCTORS / DESTRUCTOR-------------------//
-Engine::Event::EventManager::EventManager() = default;
+Engine::Event::EventManager::EventManager(bool aDrainOnRead)
+    : _drainOnRead(aDrainOnRead)
+{}
 
 Engine::Event::EventManager::~EventManager() = default;
 
@@ -13,3 +28,29 @@ Engine::Event::EventManager &Engine::Event::EventManager::getInstance()
 
     return instance;
 }
+
+std::size_t Engine::Event::EventManager::getId(std::type_index aType)
+{
+    const std::lock_guard lock(eventIdsMutex);
+    auto &ids = eventIds();
+
+    return ids.try_emplace(aType, ids.size()).first->second;
+}
+
+void Engine::Event::EventManager::drainEvents()
+{
+    for (auto &handler : _handlers) {
+        if (handler) {
+            handler->drain();
+        }
+    }
+}
+
+void Engine::Event::EventManager::swapChannels()
+{
+    for (auto &channel : _channels) {
+        if (channel) {
+            channel->swap();
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include "FixedTimestep.hpp"
+#include <cmath>
+
+namespace Engine::Core {
+    namespace {
+        constexpr double millisecondsPerSecond = 1000;
+    } // namespace
+
+    FixedTimestep::FixedTimestep(double aHertz, std::size_t aMaxSteps)
+        : _maxSteps(aMaxSteps)
+    {
+        if (aHertz < 0 || aMaxSteps == 0) {
+            throw FixedTimestepException("A fixed timestep needs a positive rate and at least one step per frame");
+        }
+        _step = aHertz > 0 ? millisecondsPerSecond / aHertz : 0;
+    }
+
+    std::size_t FixedTimestep::advance(double aElapsed)
+    {
+        if (!isFixed()) {
+            return 1;
+        }
+        _accumulator += aElapsed;
+
+        const auto steps = static_cast<std::size_t>(_accumulator / _step);
+
+        if (steps > _maxSteps) {
+            _accumulator = std::fmod(_accumulator, _step);
+            return _maxSteps;
+        }
+        _accumulator -= static_cast<double>(steps) * _step;
+        return steps;
+    }
+
+    double FixedTimestep::getAlpha() const
+    {
+        return isFixed() ? _accumulator / _step : 0;
+    }
+
+    double FixedTimestep::getStep() const
+    {
+        return _step;
+    }
+
+    std::size_t FixedTimestep::getMaxSteps() const
+    {
+        return _maxSteps;
+    }
+
+    bool FixedTimestep::isFixed() const
+    {
+        return _step > 0;
+    }
+
+    void FixedTimestep::reset()
+    {
+        _accumulator = 0;
+    }
+} // namespace Engine::Core
@@ -0,0 +1,375 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <utility>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace Engine::Core {
+    /**
+     * @brief A spawned job, shared by its handles, the queues and the jobs waiting for it
+     */
+    struct JobHandle::State
+    {
+            JobSystem::job func;
+            /// jobs waited for which aren't done yet, plus one while the continuation is being set up
+            std::atomic<std::size_t> blockers = 0;
+            std::atomic<bool> done = false;
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::vector<std::shared_ptr<State>> continuations;
+            std::exception_ptr error;
+    };
+
+    namespace {
+        constexpr std::size_t noWorker = std::numeric_limits<std::size_t>::max();
+        constexpr auto idleWait = std::chrono::microseconds(100);
+
+        thread_local const JobSystem *currentSystem = nullptr;
+        thread_local std::size_t currentWorker = noWorker;
+        thread_local std::size_t nextVictim = 0;
+
+        struct SharedSettings
+        {
+                std::size_t workers = JobSystem::getDefaultWorkerCount();
+                bool pinned = false;
+                std::atomic<bool> started = false;
+        };
+
+        SharedSettings &getSharedSettings()
+        {
+            static SharedSettings settings;
+
+            return settings;
+        }
+
+        /**
+         * @brief State of one parallelFor, the helper jobs are all waited for before it goes out of scope
+         */
+        struct ParallelLoop
+        {
+                std::atomic<std::size_t> next = 0;
+                std::mutex mutex;
+                std::exception_ptr error;
+        };
+
+        void runRanges(ParallelLoop &aLoop, std::size_t aCount, std::size_t aGrain, const JobSystem::rangeFunc &aFunc)
+        {
+            for (std::size_t begin = aLoop.next.fetch_add(aGrain); begin < aCount;
+                 begin = aLoop.next.fetch_add(aGrain)) {
+                try {
+                    aFunc(begin, std::min(begin + aGrain, aCount));
+                } catch (...) {
+                    const std::lock_guard lock(aLoop.mutex);
+
+                    if (!aLoop.error) {
+                        aLoop.error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        void inheritError(JobHandle::State &aState, const std::exception_ptr &aError)
+        {
+            if (!aError) {
+                return;
+            }
+            const std::lock_guard lock(aState.mutex);
+
+            if (!aState.error) {
+                aState.error = aError;
+            }
+        }
+    } // namespace
+
+    JobHandle::JobHandle(std::shared_ptr<State> aState)
+        : _state(std::move(aState))
+    {}
+
+    bool JobHandle::isDone() const
+    {
+        return !_state || _state->done.load(std::memory_order_acquire);
+    }
+
+    JobSystem::JobSystem(std::size_t aWorkerCount, bool aPinThreads)
+#ifdef __linux__
+        : _pinned(aPinThreads)
+#else
+        : _pinned(false)
+#endif
+    {
+        static_cast<void>(aPinThreads);
+        for (std::size_t idx = 0; idx <= aWorkerCount; idx++) {
+            _queues.push_back(std::make_unique<Queue>());
+        }
+        _workers.reserve(aWorkerCount);
+        for (std::size_t idx = 0; idx < aWorkerCount; idx++) {
+            _workers.emplace_back([this, idx]() { workerLoop(idx); });
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            const std::lock_guard lock(_sleepMutex);
+
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto &worker : _workers) {
+            worker.join();
+        }
+    }
+
+    JobHandle JobSystem::spawn(job aJob)
+    {
+        auto state = std::make_shared<JobHandle::State>();
+
+        state->func = std::move(aJob);
+        schedule(state);
+        return JobHandle(std::move(state));
+    }
+
+    JobHandle JobSystem::spawnAfter(std::span<const JobHandle> aParents, job aJob)
+    {
+        auto state = std::make_shared<JobHandle::State>();
+
+        state->func = std::move(aJob);
+        state->blockers.store(aParents.size() + 1);
+        for (const auto &parent : aParents) {
+            if (parent._state) {
+                std::unique_lock lock(parent._state->mutex);
+
+                if (!parent._state->done.load(std::memory_order_relaxed)) {
+                    parent._state->continuations.push_back(state);
+                    continue;
+                }
+                lock.unlock();
+                inheritError(*state, parent._state->error);
+            }
+            state->blockers.fetch_sub(1);
+        }
+        if (state->blockers.fetch_sub(1) == 1) {
+            schedule(state);
+        }
+        return JobHandle(std::move(state));
+    }
+
+    JobHandle JobSystem::spawnAfter(const JobHandle &aParent, job aJob)
+    {
+        return spawnAfter(std::span(&aParent, 1), std::move(aJob));
+    }
+
+    void JobSystem::wait(const JobHandle &aHandle)
+    {
+        if (!aHandle._state) {
+            return;
+        }
+        auto &state = *aHandle._state;
+        const std::size_t self = currentSystem == this ? currentWorker : noWorker;
+
+        while (!state.done.load(std::memory_order_acquire)) {
+            if (runOne(self)) {
+                continue;
+            }
+            std::unique_lock lock(state.mutex);
+
+            // woken up early by the job, else looks for queued jobs again
+            state.finished.wait_for(lock, idleWait, [&state]() { return state.done.load(); });
+        }
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+    }
+
+    void JobSystem::parallelFor(std::size_t aCount, std::size_t aGrain, const rangeFunc &aFunc)
+    {
+        const std::size_t grain = std::max<std::size_t>(aGrain, 1);
+        const std::size_t ranges = (aCount + grain - 1) / grain;
+
+        if (ranges <= 1 || _workers.empty()) {
+            for (std::size_t begin = 0; begin < aCount; begin += grain) {
+                aFunc(begin, std::min(begin + grain, aCount));
+            }
+            return;
+        }
+        const std::size_t helperCount = std::min(ranges - 1, _workers.size());
+        ParallelLoop loop;
+        std::vector<JobHandle> helpers;
+
+        helpers.reserve(helperCount);
+        for (std::size_t idx = 0; idx < helperCount; idx++) {
+            helpers.push_back(spawn([&loop, aCount, grain, &aFunc]() { runRanges(loop, aCount, grain, aFunc); }));
+        }
+        runRanges(loop, aCount, grain, aFunc);
+        for (const auto &helper : helpers) {
+            wait(helper);
+        }
+        if (loop.error) {
+            std::rethrow_exception(loop.error);
+        }
+    }
+
+    std::size_t JobSystem::getWorkerCount() const
+    {
+        return _workers.size();
+    }
+
+    bool JobSystem::isPinned() const
+    {
+        return _pinned;
+    }
+
+    JobSystem &JobSystem::getShared()
+    {
+        auto &settings = getSharedSettings();
+        static JobSystem instance(settings.workers, settings.pinned);
+
+        settings.started.store(true);
+        return instance;
+    }
+
+    void JobSystem::configureShared(std::size_t aWorkerCount, bool aPinThreads)
+    {
+        auto &settings = getSharedSettings();
+
+        if (settings.started.load()) {
+            throw JobSystemExceptionAlreadyStarted("The shared job system is already started");
+        }
+        settings.workers = aWorkerCount;
+        settings.pinned = aPinThreads;
+    }
+
+    std::size_t JobSystem::getDefaultWorkerCount()
+    {
+        const std::size_t hardware = std::thread::hardware_concurrency();
+
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    void JobSystem::schedule(std::shared_ptr<JobHandle::State> aState)
+    {
+        const std::size_t target = currentSystem == this ? currentWorker : _workers.size();
+
+        {
+            const std::lock_guard lock(_queues[target]->mutex);
+
+            _queues[target]->jobs.push_back(std::move(aState));
+        }
+        _queued.fetch_add(1);
+        {
+            // a worker checks _queued under this lock before sleeping, taking it here means no wake up is lost
+            const std::lock_guard lock(_sleepMutex);
+        }
+        _wake.notify_one();
+    }
+
+    std::shared_ptr<JobHandle::State> JobSystem::take(std::size_t aQueue)
+    {
+        std::shared_ptr<JobHandle::State> found;
+
+        if (aQueue != noWorker) {
+            const std::lock_guard lock(_queues[aQueue]->mutex);
+            auto &jobs = _queues[aQueue]->jobs;
+
+            if (!jobs.empty()) {
+                found = std::move(jobs.back());
+                jobs.pop_back();
+                return found;
+            }
+        }
+        // the injection queue first, then steal the oldest job of the other workers
+        for (std::size_t tried = 0; tried < _queues.size(); tried++) {
+            const std::size_t victim = tried == 0 ? _workers.size() : nextVictim++ % _workers.size();
+
+            if (victim == aQueue) {
+                continue;
+            }
+            const std::lock_guard lock(_queues[victim]->mutex);
+            auto &jobs = _queues[victim]->jobs;
+
+            if (!jobs.empty()) {
+                found = std::move(jobs.front());
+                jobs.pop_front();
+                return found;
+            }
+        }
+        return found;
+    }
+
+    bool JobSystem::runOne(std::size_t aQueue)
+    {
+        if (_queued.load() == 0) {
+            return false;
+        }
+        const auto state = take(aQueue);
+
+        if (!state) {
+            return false;
+        }
+        _queued.fetch_sub(1);
+        execute(state);
+        return true;
+    }
+
+    void JobSystem::execute(const std::shared_ptr<JobHandle::State> &aState)
+    {
+        std::vector<std::shared_ptr<JobHandle::State>> continuations;
+
+        if (!aState->error) {
+            try {
+                aState->func();
+            } catch (...) {
+                aState->error = std::current_exception();
+            }
+        }
+        aState->func = nullptr;
+        {
+            const std::lock_guard lock(aState->mutex);
+
+            aState->done.store(true, std::memory_order_release);
+            continuations.swap(aState->continuations);
+        }
+        aState->finished.notify_all();
+        for (auto &next : continuations) {
+            inheritError(*next, aState->error);
+            if (next->blockers.fetch_sub(1) == 1) {
+                schedule(std::move(next));
+            }
+        }
+    }
+
+    void JobSystem::workerLoop(std::size_t aIndex)
+    {
+        currentSystem = this;
+        currentWorker = aIndex;
+        nextVictim = aIndex + 1;
+#ifdef __linux__
+        if (_pinned) {
+            const std::size_t cores = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            cpu_set_t set;
+
+            CPU_ZERO(&set);
+            // core 0 is left to the thread which created the job system
+            CPU_SET((aIndex + 1) % cores, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#endif
+        while (true) {
+            if (runOne(aIndex)) {
+                continue;
+            }
+            std::unique_lock lock(_sleepMutex);
+
+            _wake.wait(lock, [this]() { return _stopping || _queued.load() > 0; });
+            if (_stopping && _queued.load() == 0) {
+                return;
+            }
+        }
+    }
+} // namespace Engine::Core
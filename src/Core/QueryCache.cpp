@@ -0,0 +1,73 @@
+#include "QueryCache.hpp"
+
+namespace Engine::Core {
+    QueryCache::QueryCache(const Signature &aMask, const Signature &aExclude)
+        : _mask(aMask),
+          _exclude(aExclude)
+    {}
+
+    void QueryCache::refresh(id aEntity, const Signature &aSignature)
+    {
+        const bool matches = aSignature.contains(_mask) && !aSignature.intersects(_exclude);
+
+        if (matches && !contains(aEntity)) {
+            insert(aEntity);
+        } else if (!matches) {
+            remove(aEntity);
+        }
+    }
+
+    void QueryCache::remove(id aEntity)
+    {
+        if (!contains(aEntity)) {
+            return;
+        }
+        const position pos = _positions[aEntity];
+        const id last = _entities.back();
+
+        _entities[pos] = last;
+        _positions[last] = pos;
+        _entities.pop_back();
+        _positions[aEntity] = npos;
+    }
+
+    void QueryCache::clear()
+    {
+        _entities.clear();
+        _positions.clear();
+    }
+
+    bool QueryCache::contains(id aEntity) const
+    {
+        return aEntity < _positions.size() && _positions[aEntity] != npos;
+    }
+
+    std::span<const QueryCache::id> QueryCache::getEntities() const
+    {
+        return _entities;
+    }
+
+    std::size_t QueryCache::size() const
+    {
+        return _entities.size();
+    }
+
+    const Signature &QueryCache::getMask() const
+    {
+        return _mask;
+    }
+
+    const Signature &QueryCache::getExcludeMask() const
+    {
+        return _exclude;
+    }
+
+    void QueryCache::insert(id aEntity)
+    {
+        if (aEntity >= _positions.size()) {
+            _positions.resize(aEntity + 1, npos);
+        }
+        _positions[aEntity] = static_cast<position>(_entities.size());
+        _entities.push_back(aEntity);
+    }
+} // namespace Engine::Core
@@ -0,0 +1,235 @@
+#include "Systems/SystemScheduler.hpp"
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <queue>
+
+namespace Engine::Core {
+    void SystemScheduler::build(const std::vector<entry> &aSystems)
+    {
+        const std::size_t count = aSystems.size();
+        std::vector<std::vector<bool>> constrained(count, std::vector<bool>(count, false));
+        auto index = [&aSystems](const std::string &aName) {
+            const auto found = std::find_if(aSystems.begin(), aSystems.end(),
+                                            [&aName](const entry &aEntry) { return aEntry.name == aName; });
+
+            if (found == aSystems.end()) {
+                throw SystemSchedulerExceptionUnknownSystem("Unknown system in a constraint: " + aName);
+            }
+            return static_cast<std::size_t>(std::distance(aSystems.begin(), found));
+        };
+
+        for (std::size_t idx = 0; idx < count; idx++) {
+            for (const auto &name : aSystems[idx].system->getBefore()) {
+                constrained[idx][index(name)] = true;
+            }
+            for (const auto &name : aSystems[idx].system->getAfter()) {
+                constrained[index(name)][idx] = true;
+            }
+        }
+        // each system waits for the systems of the previous stage which has systems
+        for (std::size_t previous = 0, begin = 0; begin < count;) {
+            std::size_t end = begin;
+
+            while (end < count && aSystems[end].stage == aSystems[begin].stage) {
+                end++;
+            }
+            for (std::size_t from = previous; from < begin; from++) {
+                for (std::size_t to = begin; to < end; to++) {
+                    constrained[from][to] = true;
+                }
+            }
+            previous = begin;
+            begin = end;
+        }
+
+        // order the systems by their constraints, the smallest default position first among the ready ones
+        std::vector<std::size_t> pending(count, 0);
+        std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> ready;
+        std::vector<std::size_t> order;
+
+        for (std::size_t from = 0; from < count; from++) {
+            for (std::size_t to = 0; to < count; to++) {
+                pending[to] += constrained[from][to] ? 1U : 0U;
+            }
+        }
+        for (std::size_t idx = 0; idx < count; idx++) {
+            if (pending[idx] == 0) {
+                ready.push(idx);
+            }
+        }
+        while (!ready.empty()) {
+            const std::size_t current = ready.top();
+
+            ready.pop();
+            order.push_back(current);
+            for (std::size_t to = 0; to < count; to++) {
+                if (constrained[current][to] && --pending[to] == 0) {
+                    ready.push(to);
+                }
+            }
+        }
+        if (order.size() != count) {
+            throw SystemSchedulerExceptionCycle("The system constraints form a cycle");
+        }
+
+        _systems.clear();
+        _names.clear();
+        _successors.assign(count, {});
+        _predecessors.assign(count, {});
+        for (const auto idx : order) {
+            _systems.push_back(aSystems[idx].system);
+            _names.push_back(aSystems[idx].name);
+        }
+        for (std::size_t from = 0; from < count; from++) {
+            for (std::size_t to = from + 1; to < count; to++) {
+                if (constrained[order[from]][order[to]] || _systems[from]->conflictsWith(*_systems[to])) {
+                    _successors[from].push_back(to);
+                    _predecessors[to].push_back(from);
+                }
+            }
+        }
+    }
+
+    void SystemScheduler::run(JobSystem &aJobs, double aElapsed, std::size_t aWorld, std::atomic<tick> &aTick,
+                              std::atomic<std::size_t> &aConcurrent)
+    {
+        const std::size_t count = _systems.size();
+        std::vector<std::size_t> steps(count, 0);
+        std::size_t passes = 1;
+        double fastest = 0;
+
+        _alpha = 0;
+        for (std::size_t idx = 0; idx < count; idx++) {
+            auto &timestep = _systems[idx]->getTimestep();
+
+            if (!_systems[idx]->_isActivated) {
+                // a deactivated system doesn't catch up on the time it was off once activated again
+                timestep.reset();
+                continue;
+            }
+            steps[idx] = timestep.advance(aElapsed);
+            if (timestep.isFixed()) {
+                _systems[idx]->setFrameTime(timestep.getStep(), timestep.getAlpha());
+                passes = std::max(passes, steps[idx]);
+                if (fastest == 0 || timestep.getStep() < fastest) {
+                    fastest = timestep.getStep();
+                    _alpha = timestep.getAlpha();
+                }
+            }
+        }
+        std::vector<bool> active(count, false);
+
+        for (std::size_t pass = 0; pass < passes; pass++) {
+            for (std::size_t idx = 0; idx < count; idx++) {
+                const bool fixed = _systems[idx]->getTimestep().isFixed();
+
+                active[idx] = fixed ? pass + steps[idx] >= passes : pass + 1 == passes && steps[idx] > 0;
+                if (!fixed && active[idx]) {
+                    _systems[idx]->setFrameTime(aElapsed, _alpha);
+                }
+            }
+            runPass(aJobs, active, aWorld, aTick, aConcurrent);
+        }
+    }
+
+    double SystemScheduler::getAlpha() const
+    {
+        return _alpha;
+    }
+
+    void SystemScheduler::runPass(JobSystem &aJobs, const std::vector<bool> &aActive, std::size_t aWorld,
+                                  std::atomic<tick> &aTick, std::atomic<std::size_t> &aConcurrent)
+    {
+        std::vector<JobHandle> handles(_systems.size());
+        std::vector<JobHandle> parents;
+        std::exception_ptr error;
+
+        // the systems are in a topological order, the jobs of the predecessors are always spawned first
+        for (std::size_t idx = 0; idx < _systems.size(); idx++) {
+            System *system = _systems[idx];
+
+            parents.clear();
+            for (const auto previous : _predecessors[idx]) {
+                parents.push_back(handles[previous]);
+            }
+            if (aActive[idx]) {
+                const ChangeTicks ticks = system->beginRun(aWorld, aTick.fetch_add(1) + 1);
+
+                handles[idx] = aJobs.spawnAfter(parents, [system, ticks, &aConcurrent]() {
+                    const ChangeTicks::Scope scope(ticks);
+
+                    // a system without declared access runs alone, it may change the structure of the World
+                    if (!system->hasAccess()) {
+                        system->update();
+                        return;
+                    }
+                    aConcurrent.fetch_add(1);
+                    try {
+                        system->update();
+                    } catch (...) {
+                        aConcurrent.fetch_sub(1);
+                        throw;
+                    }
+                    aConcurrent.fetch_sub(1);
+                });
+            } else if (!parents.empty()) {
+                handles[idx] = aJobs.spawnAfter(parents, []() {});
+            }
+        }
+        for (const auto &handle : handles) {
+            try {
+                aJobs.wait(handle);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool SystemScheduler::dependsOn(const std::string &aSystem, const std::string &aOther) const
+    {
+        const std::size_t target = find(aSystem);
+        std::vector<bool> reached(_systems.size(), false);
+
+        reached[find(aOther)] = true;
+        // successors always come later in _systems, one forward pass propagates the reachability
+        for (std::size_t idx = 0; idx < _systems.size(); idx++) {
+            if (!reached[idx]) {
+                continue;
+            }
+            for (const auto next : _successors[idx]) {
+                reached[next] = true;
+            }
+        }
+        return target != find(aOther) && reached[target];
+    }
+
+    std::size_t SystemScheduler::getCriticalPathLength() const
+    {
+        std::vector<std::size_t> length(_systems.size(), 1);
+        std::size_t longest = 0;
+
+        for (std::size_t idx = 0; idx < _systems.size(); idx++) {
+            for (const auto next : _successors[idx]) {
+                length[next] = std::max(length[next], length[idx] + 1);
+            }
+            longest = std::max(longest, length[idx]);
+        }
+        return longest;
+    }
+
+    std::size_t SystemScheduler::find(const std::string &aName) const
+    {
+        const auto found = std::find(_names.begin(), _names.end(), aName);
+
+        if (found == _names.end()) {
+            throw SystemSchedulerExceptionUnknownSystem("Unknown system: " + aName);
+        }
+        return static_cast<std::size_t>(std::distance(_names.begin(), found));
+    }
+} // namespace Engine::Core
@@ -0,0 +1,175 @@
+#include "Task.hpp"
+
+namespace Engine::Core {
+    void *TaskPool::allocate(std::size_t aSize)
+    {
+        if (aSize > maxPooledSize) {
+            return ::operator new(aSize);
+        }
+        auto &sizeClass = _classes[(aSize - 1) / blockAlign];
+        const std::lock_guard lock(sizeClass.mutex);
+
+        if (sizeClass.free == nullptr) {
+            const std::size_t blockSize = ((aSize - 1) / blockAlign + 1) * blockAlign;
+            auto &slab = sizeClass.slabs.emplace_back(std::make_unique<std::byte[]>(blockSize * slabBlocks));
+
+            for (std::size_t idx = slabBlocks; idx-- > 0;) {
+                auto *block = reinterpret_cast<FreeBlock *>(slab.get() + idx * blockSize);
+
+                block->next = sizeClass.free;
+                sizeClass.free = block;
+            }
+        }
+        FreeBlock *block = sizeClass.free;
+
+        sizeClass.free = block->next;
+        return block;
+    }
+
+    void TaskPool::deallocate(void *aBlock, std::size_t aSize) noexcept
+    {
+        if (aSize > maxPooledSize) {
+            ::operator delete(aBlock);
+            return;
+        }
+        auto &sizeClass = _classes[(aSize - 1) / blockAlign];
+        const std::lock_guard lock(sizeClass.mutex);
+        auto *block = static_cast<FreeBlock *>(aBlock);
+
+        block->next = sizeClass.free;
+        sizeClass.free = block;
+    }
+
+    std::size_t TaskPool::getReservedBlocks()
+    {
+        std::size_t blocks = 0;
+
+        for (auto &sizeClass : _classes) {
+            const std::lock_guard lock(sizeClass.mutex);
+
+            blocks += sizeClass.slabs.size() * slabBlocks;
+        }
+        return blocks;
+    }
+
+    TaskPool &TaskPool::getShared()
+    {
+        static TaskPool instance;
+
+        return instance;
+    }
+
+    Task::Task(handle aHandle)
+        : _handle(aHandle)
+    {}
+
+    Task::~Task()
+    {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    Task::Task(Task &&other) noexcept
+        : _handle(std::exchange(other._handle, nullptr))
+    {}
+
+    Task &Task::operator=(Task &&other) noexcept
+    {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task::handle Task::release()
+    {
+        return std::exchange(_handle, nullptr);
+    }
+
+    TaskScheduler::TaskScheduler()
+        : TaskScheduler(Engine::Event::EventManager::getInstance())
+    {}
+
+    TaskScheduler::TaskScheduler(Engine::Event::EventManager &aEvents)
+        : _events(&aEvents)
+    {}
+
+    TaskScheduler::~TaskScheduler()
+    {
+        for (const auto &waiting : _waiting) {
+            waiting.handle.destroy();
+        }
+    }
+
+    void TaskScheduler::start(Task aTask)
+    {
+        const auto handle = aTask.release();
+
+        if (!handle) {
+            throw TaskException("The task was already started");
+        }
+        suspend(handle, &TaskScheduler::always, nullptr);
+    }
+
+    void TaskScheduler::resume(double aElapsed)
+    {
+        std::exception_ptr error;
+
+        _time += aElapsed;
+        {
+            const std::lock_guard lock(_mutex);
+
+            _resuming.swap(_waiting);
+        }
+        for (const auto &waiting : _resuming) {
+            if (!waiting.ready(waiting.awaiter, *this)) {
+                const std::lock_guard lock(_mutex);
+
+                _waiting.push_back(waiting);
+                continue;
+            }
+            waiting.handle.resume();
+            if (!waiting.handle.done()) {
+                continue;
+            }
+            auto task = Task::handle::from_address(waiting.handle.address());
+
+            if (task.promise().error && !error) {
+                error = task.promise().error;
+            }
+            task.destroy();
+        }
+        _resuming.clear();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::size_t TaskScheduler::getTaskCount()
+    {
+        const std::lock_guard lock(_mutex);
+
+        return _waiting.size();
+    }
+
+    double TaskScheduler::getTime() const
+    {
+        return _time;
+    }
+
+    Engine::Event::EventManager &TaskScheduler::getEventManager() const
+    {
+        return *_events;
+    }
+
+    void TaskScheduler::suspend(std::coroutine_handle<> aHandle, readyFunc aReady, void *aAwaiter)
+    {
+        const std::lock_guard lock(_mutex);
+
+        _waiting.push_back({aHandle, aReady, aAwaiter});
+    }
+} // namespace Engine::Core
@@ -7,53 +7,372 @@
 
 #include "World.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
 #include <spdlog/spdlog.h>
 
 namespace Engine::Core {
-    std::size_t World::createEntity()
+    World::World(WorldStorage aStorage)
+        : _storage(aStorage)
+    {
+        if (_storage == WorldStorage::Archetypes) {
+            _archetypes = std::make_unique<ArchetypeStorage>();
+        }
+    }
+
+    Entity World::createEntity()
     {
         std::size_t newIdx = 0;
 
+        checkNoConcurrentSystem();
         if (_ids.empty()) {
             newIdx = _nextId;
-            _nextId++;
+            growEntities(1);
         } else {
-            const auto smallestIdx = std::min_element(_ids.begin(), _ids.end());
-
-            _ids.erase(smallestIdx);
-            newIdx = *smallestIdx;
+            newIdx = _ids.back();
+            _ids.pop_back();
+            _alive[newIdx] = true;
         }
         spdlog::debug("Creating entity {}", newIdx);
-        for (const auto &component : _components) {
-            auto initFunc = getInitFunc(component.first);
+        return spawnEntity(newIdx);
+    }
+
+    std::vector<Entity> World::createEntities(std::size_t aCount)
+    {
+        const std::size_t reused = std::min(aCount, _ids.size());
+        const std::size_t first = _nextId;
+        std::vector<Entity> entities;
 
-            initFunc(*this, newIdx);
+        checkNoConcurrentSystem();
+        growEntities(aCount - reused);
+        spdlog::debug("Creating {} entities", aCount);
+        entities.reserve(aCount);
+        for (std::size_t idx = 0; idx < reused; idx++) {
+            const std::size_t newIdx = _ids.back();
+
+            _ids.pop_back();
+            _alive[newIdx] = true;
+            entities.push_back(spawnEntity(newIdx));
+        }
+        for (std::size_t newIdx = first; newIdx < _nextId; newIdx++) {
+            entities.push_back(spawnEntity(newIdx));
         }
-        return newIdx;
+        return entities;
     }
 
     void World::killEntity(std::size_t aIndex)
     {
+        checkNoConcurrentSystem();
+        if (!isAlive(aIndex)) {
+            return;
+        }
         spdlog::debug("Killing entity {}", aIndex);
-        _ids.push_back(aIndex);
+        destroyEntity(aIndex);
+    }
+
+    void World::killEntities(std::span<const Entity> aEntities)
+    {
+        checkNoConcurrentSystem();
+        for (const auto entity : aEntities) {
+            static_cast<void>(checkAlive(entity));
+        }
+        spdlog::debug("Killing {} entities", aEntities.size());
+        _ids.reserve(_ids.size() + aEntities.size());
+        for (const auto entity : aEntities) {
+            if (isAlive(entity.getIndex())) {
+                destroyEntity(entity.getIndex());
+            }
+        }
+    }
+
+    void World::killEntity(Entity aEntity)
+    {
+        killEntity(checkAlive(aEntity));
+    }
+
+    bool World::isAlive(Entity aEntity) const
+    {
+        const std::size_t idx = aEntity.getIndex();
+
+        return isAlive(idx) && _generations[idx] == aEntity.getGeneration();
+    }
+
+    bool World::isAlive(std::size_t aIndex) const
+    {
+        return aIndex < _alive.size() && _alive[aIndex];
+    }
 
-        for (const auto &component : _components) {
-            auto eraseFunc = getEraseFunc(component.first);
+    Entity World::getEntity(std::size_t aIndex) const
+    {
+        if (!isAlive(aIndex)) {
+            throw WorldExceptionStaleEntity("No live entity at index " + std::to_string(aIndex));
+        }
+        return {static_cast<Entity::index>(aIndex), _generations[aIndex]};
+    }
 
-            eraseFunc(*this, aIndex);
+    std::size_t World::checkAlive(Entity aEntity) const
+    {
+        if (!isAlive(aEntity)) {
+            throw WorldExceptionStaleEntity("Stale entity handle: " + std::to_string(aEntity.getIndex()));
         }
+        return aEntity.getIndex();
+    }
+
+    std::vector<std::size_t> World::filterEntities(const Signature &aMask, const Signature &aExclude) const
+    {
+        std::vector<std::size_t> matches;
+
+        if (aMask.none()) {
+            for (std::size_t idx = 0; idx < _alive.size(); idx++) {
+                if (_alive[idx] && !_signatures[idx].intersects(aExclude)) {
+                    matches.push_back(idx);
+                }
+            }
+            return matches;
+        }
+        Signature::filter(_signatures, aMask, matches);
+        if (!aExclude.none()) {
+            std::erase_if(matches, [this, &aExclude](std::size_t aIndex) {
+                return _signatures[aIndex].intersects(aExclude);
+            });
+        }
+        return matches;
     }
 
     void World::runSystems()
     {
-        for (auto &system : _systems) {
-            system.second->update();
+        runSystems(_clock.restart());
+    }
+
+    void World::runSystems(double aElapsed)
+    {
+        // the only drain of the frame, the systems and the tasks then read the events without any writer
+        _events->drainEvents();
+        _tasks->resume(aElapsed);
+        if (_systemsChanged) {
+            std::vector<SystemScheduler::entry> entries;
+
+            entries.reserve(_systemStages.size());
+            for (std::size_t stage = 0; stage < stageCount; stage++) {
+                for (auto &system : _systems[stage]) {
+                    entries.push_back({system.first, system.second.get(), static_cast<Stage>(stage)});
+                }
+            }
+            _scheduler.build(entries);
+            _systemsChanged = false;
+        }
+        for (auto &stage : _systems) {
+            for (auto &system : stage) {
+                if (system.second->_isActivated) {
+                    system.second->prepare();
+                }
+            }
+        }
+        _scheduler.run(JobSystem::getShared(), aElapsed, _id, *_tick, *_concurrentSystems);
+        // the changes made until the next frame come after every run of this one
+        _tick->fetch_add(1);
+        flushCommands();
+        takeSnapshots();
+        _events->swapChannels();
+    }
+
+    CommandBuffer &World::getCommandBuffer()
+    {
+        // the buffers this thread already has, by World id
+        thread_local std::vector<std::pair<std::size_t, CommandBuffer *>> buffers;
+
+        for (const auto &[world, buffer] : buffers) {
+            if (world == _id) {
+                return *buffer;
+            }
+        }
+        const std::lock_guard lock(*_commandBuffersMutex);
+        auto &buffer = _commandBuffers.emplace_back(std::make_unique<CommandBuffer>());
+
+        buffers.emplace_back(_id, buffer.get());
+        return *buffer;
+    }
+
+    void World::flushCommands()
+    {
+        for (auto &buffer : _commandBuffers) {
+            buffer->submit(*this, _commands);
+        }
+        _commands.apply(*this);
+    }
+
+    System &World::getSystem(const std::string &aName)
+    {
+        const auto found = _systemStages.find(aName);
+
+        if (found == _systemStages.end()) {
+            throw WorldExceptionSystemNotRegistered("System not registered");
+        }
+        for (auto &system : _systems[static_cast<std::size_t>(found->second)]) {
+            if (system.first == aName) {
+                return *system.second;
+            }
+        }
+        throw WorldExceptionSystemNotRegistered("System not registered");
+    }
+
+    void World::setSystemActive(const std::string &aName, bool aActive)
+    {
+        getSystem(aName)._isActivated = aActive;
+    }
+
+    double World::getAlpha() const
+    {
+        return _scheduler.getAlpha();
+    }
+
+    std::size_t World::takeId()
+    {
+        static std::atomic<std::size_t> nextId = 0;
+
+        return nextId++;
+    }
+
+    void World::startTask(Task aTask)
+    {
+        _tasks->start(std::move(aTask));
+    }
+
+    TaskScheduler &World::getTasks()
+    {
+        return *_tasks;
+    }
+
+    Engine::Event::EventManager &World::getEventManager()
+    {
+        return *_events;
+    }
+
+    void World::takeSnapshots()
+    {
+        JobSystem::getShared().parallelFor(_snapshotCopies.size(), 1, [this](std::size_t aBegin, std::size_t aEnd) {
+            for (std::size_t idx = aBegin; idx < aEnd; idx++) {
+                if (_snapshotCopies[idx]) {
+                    _snapshotCopies[idx]();
+                }
+            }
+        });
+    }
+
+    ChangeTicks World::getChangeTicks() const
+    {
+        const auto &current = ChangeTicks::getCurrent();
+
+        if (current.world == _id) {
+            return current;
         }
+        return {_id, 0, _tick->load()};
+    }
+
+    const SystemScheduler &World::getSystemScheduler() const
+    {
+        return _scheduler;
     }
 
     std::size_t World::getCurrentId() const
     {
         return _nextId;
     }
+
+    WorldStorage World::getStorage() const
+    {
+        return _storage;
+    }
+
+    void World::checkNoConcurrentSystem() const
+    {
+        if (_concurrentSystems->load() > 0) {
+            throw WorldExceptionSystemsRunning(
+                "Structural change while systems with declared access run, record it in getCommandBuffer instead");
+        }
+    }
+
+    void World::refreshQueries(std::size_t aComponentId, std::size_t aIndex)
+    {
+        if (aComponentId >= _queriesByComponent.size()) {
+            return;
+        }
+        for (auto *query : _queriesByComponent[aComponentId]) {
+            query->refresh(aIndex, _signatures[aIndex]);
+        }
+    }
+
+    void World::indexQuery(QueryCache &aQuery)
+    {
+        auto link = [this, &aQuery](std::size_t aComponentId) {
+            if (aComponentId >= _queriesByComponent.size()) {
+                _queriesByComponent.resize(aComponentId + 1);
+            }
+            _queriesByComponent[aComponentId].push_back(&aQuery);
+        };
+
+        aQuery.getMask().forEach(link);
+        aQuery.getExcludeMask().forEach(link);
+    }
+
+    void World::growEntities(std::size_t aCount)
+    {
+        if (aCount > Entity::invalidIndex - _nextId) {
+            throw WorldException("Too many entities");
+        }
+        _nextId += aCount;
+        _generations.resize(_nextId, 0);
+        _alive.resize(_nextId, true);
+        if (_signatures.size() < _nextId) {
+            _signatures.resize(_nextId);
+        }
+    }
+
+    Entity World::spawnEntity(std::size_t aIndex)
+    {
+        // killing an entity empties its signature, and nothing is added at a dead index
+        assert(_signatures[aIndex].none());
+        if (_archetypes) {
+            _archetypes->createEntity(aIndex);
+        } else {
+            for (auto &query : _queries) {
+                if (query->getMask().none()) {
+                    query->refresh(aIndex, _signatures[aIndex]);
+                }
+            }
+        }
+        return {static_cast<Entity::index>(aIndex), _generations[aIndex]};
+    }
+
+    void World::destroyEntity(std::size_t aIndex)
+    {
+        _alive[aIndex] = false;
+        _generations[aIndex]++;
+        _ids.push_back(aIndex);
+
+        if (_archetypes) {
+            _archetypes->killEntity(aIndex);
+            return;
+        }
+        _signatures[aIndex].forEach([this, aIndex](std::size_t aComponentId) {
+            _components[aComponentId]->erase(aIndex);
+        });
+        _signatures[aIndex] = Signature();
+        for (auto &query : _queries) {
+            query->remove(aIndex);
+        }
+    }
+
+    void World::addToSignature(std::size_t aComponentId, std::size_t aIndex)
+    {
+        if (aIndex >= _signatures.size()) {
+            _signatures.resize(aIndex + 1);
+        }
+        _signatures[aIndex].set(aComponentId);
+        refreshQueries(aComponentId, aIndex);
+    }
 } // namespace Engine::Core
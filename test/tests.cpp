@@ -1,8 +1,16 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdio>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "Core/Libraries/PluginLoader.hpp"
 #include "Core/Systems/GenericSystem.hpp"
 #include "Core/Systems/System.hpp"
@@ -101,6 +109,46 @@ class MySystemClass : public Engine::Core::System
         }
 };
 
+struct TaskEvent
+{
+        int value;
+};
+
+Engine::Core::Task countFrames(Engine::Core::World &world, int &counter, int frames)
+{
+    for (int frame = 0; frame < frames; frame++) {
+        counter++;
+        co_await world.getTasks().nextFrame();
+    }
+}
+
+Engine::Core::Task waitTime(Engine::Core::World &world, double time, bool &done)
+{
+    co_await world.getTasks().delay(time);
+    done = true;
+}
+
+Engine::Core::Task waitEvent(Engine::Core::World &world, int &value)
+{
+    const auto event = co_await world.getTasks().waitEvent<TaskEvent>();
+
+    value = event.value;
+}
+
+Engine::Core::Task loadAsset(Engine::Core::World &world, Engine::Core::JobSystem &jobs, int &asset)
+{
+    int loaded = 0;
+
+    co_await world.getTasks().waitJob(jobs.spawn([&loaded]() { loaded = 42; }));
+    asset = loaded;
+}
+
+Engine::Core::Task failAfterAFrame(Engine::Core::World &world)
+{
+    co_await world.getTasks().nextFrame();
+    throw std::runtime_error("task failed");
+}
+
 TEST_CASE("World", "[World]")
 {
     Engine::Core::World world;
@@ -125,7 +173,83 @@ TEST_CASE("World", "[World]")
     {
         auto entity = world.createEntity();
         world.killEntity(entity);
-        REQUIRE(entity == world.createEntity());
+        auto reused = world.createEntity();
+        REQUIRE(entity.getIndex() == reused.getIndex());
+        REQUIRE(entity != reused);
+        REQUIRE_FALSE(world.isAlive(entity));
+        REQUIRE(world.isAlive(reused));
+    }
+    SECTION("Stale handles are rejected")
+    {
+        world.registerComponents<hp1>();
+        auto entity = world.createEntity();
+        world.killEntity(entity);
+        world.createEntity();
+
+        REQUIRE_THROWS_AS(world.addComponentToEntity(entity, hp1 {}), Engine::Core::WorldExceptionStaleEntity);
+        REQUIRE_THROWS_AS(world.killEntity(entity), Engine::Core::WorldExceptionStaleEntity);
+        REQUIRE_FALSE(world.hasComponents<hp1>(entity));
+    }
+    SECTION("Dead indexes are rejected")
+    {
+        world.registerComponents<hp1>();
+        auto entity = world.createEntity();
+        world.killEntity(entity);
+
+        REQUIRE_THROWS_AS(world.addComponentToEntity(std::size_t {0}, hp1 {7}),
+                          Engine::Core::WorldExceptionStaleEntity);
+        REQUIRE_THROWS_AS(world.emplaceComponentToEntity<hp1>(std::size_t {0}, 7),
+                          Engine::Core::WorldExceptionStaleEntity);
+        auto reused = world.createEntity();
+        REQUIRE(reused.getIndex() == 0);
+        REQUIRE_FALSE(world.hasComponents<hp1>(reused));
+    }
+    SECTION("The pools see no component on entities created after they last grew")
+    {
+        world.registerComponents<hp1>();
+        auto entity = world.createEntity();
+        world.addComponentToEntity(entity, hp1 {1});
+        world.killEntity(entity);
+        auto reused = world.createEntity();
+        auto fresh = world.createEntity();
+
+        REQUIRE_FALSE(world.getComponent<hp1>().has(reused));
+        REQUIRE_FALSE(world.getComponent<hp1>().has(fresh));
+        REQUIRE_FALSE(world.hasComponents<hp1>(fresh));
+    }
+    SECTION("Freed indices are reused last in, first out")
+    {
+        auto entity = world.createEntity();
+        auto entity2 = world.createEntity();
+        world.killEntity(entity);
+        world.killEntity(entity2);
+
+        REQUIRE(world.createEntity().getIndex() == entity2.getIndex());
+        REQUIRE(world.createEntity().getIndex() == entity.getIndex());
+        REQUIRE(world.getEntity(entity.getIndex()).getGeneration() == 1);
+    }
+    SECTION("Spawn and despawn in bulk")
+    {
+        constexpr std::size_t burst = 5000;
+        constexpr int hps = 3;
+
+        world.registerComponents<hp1>();
+        auto first = world.createEntity();
+        world.killEntity(first);
+
+        auto entities = world.createEntities(burst);
+        REQUIRE(entities.size() == burst);
+        REQUIRE(entities.front().getIndex() == first.getIndex());
+        REQUIRE(entities.back().getIndex() == burst - 1);
+        world.emplaceComponents<hp1>(entities, hps);
+        REQUIRE(world.getComponent<hp1>().count() == burst);
+        REQUIRE(world.getEntityComponent<hp1>(entities[42]).hp == hps);
+
+        world.killEntities(std::span(entities).first(burst / 2));
+        REQUIRE(world.getComponent<hp1>().count() == burst / 2);
+        REQUIRE_FALSE(world.isAlive(entities.front()));
+        REQUIRE_THROWS_AS(world.killEntities(entities), Engine::Core::WorldExceptionStaleEntity);
+        REQUIRE(world.isAlive(entities.back()));
     }
 
     SECTION("Run a system")
@@ -169,6 +293,1417 @@ TEST_CASE("World", "[World]")
     }
 }
 
+TEST_CASE("Archetype World", "[World]")
+{
+    constexpr int hps = 10;
+    Engine::Core::World world(Engine::Core::WorldStorage::Archetypes);
+
+    world.registerComponents<hp1, hp2>();
+
+    SECTION("Run a system")
+    {
+        auto MySystem = Engine::Core::createSystem<hp1, hp2>(
+            world, "MySystem",
+            [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1, hp2 &cop2) {
+                cop1.hp--;
+                cop2.maxHp -= 2;
+            });
+        world.addSystem(MySystem);
+
+        auto entity = world.createEntity();
+        auto entity2 = world.createEntity();
+
+        world.addComponentToEntity(entity, hp1 {hps});
+        world.addComponentToEntity(entity, hp2 {hps});
+        world.addComponentToEntity(entity2, hp2 {hps});
+        world.runSystems();
+        REQUIRE(world.getEntityComponent<hp1>(entity).hp == hps - 1);
+        REQUIRE(world.getEntityComponent<hp2>(entity).maxHp == hps - 2);
+        REQUIRE(world.getEntityComponent<hp2>(entity2).maxHp == hps);
+        REQUIRE_THROWS_AS(world.getComponent<hp1>(), Engine::Core::WorldExceptionWrongStorage);
+    }
+    SECTION("Adding and removing components moves the entity")
+    {
+        auto entity = world.createEntity();
+
+        world.emplaceComponentToEntity<hp1>(entity, hps);
+        REQUIRE(world.hasComponents<hp1>(entity));
+        REQUIRE_FALSE(world.hasComponents<hp1, hp2>(entity));
+        world.addComponentToEntity(entity, hp2 {hps + 1});
+        REQUIRE(world.hasComponents<hp1, hp2>(entity));
+        world.removeComponentFromEntity<hp1>(entity);
+        REQUIRE_FALSE(world.hasComponents<hp1>(entity));
+        REQUIRE(world.getEntityComponent<hp2>(entity).maxHp == hps + 1);
+        world.removeComponent<hp2>();
+        REQUIRE_THROWS_AS(world.hasComponents<hp2>(entity), Engine::Core::WorldExceptionComponentNotRegistered);
+    }
+    SECTION("Entities spread over several chunks stay consistent")
+    {
+        constexpr std::size_t entities = 5000;
+
+        for (std::size_t idx = 0; idx < entities; idx++) {
+            auto entity = world.createEntity();
+
+            world.addComponentToEntity(entity, hp1 {static_cast<int>(idx)});
+            if (idx % 2 == 0) {
+                world.addComponentToEntity(entity, hp2 {static_cast<int>(idx)});
+            }
+        }
+        for (std::size_t idx = 0; idx < entities; idx += 4) {
+            world.killEntity(idx);
+        }
+
+        std::size_t visited = 0;
+        world.query<hp1, hp2>().forEach(0, [&visited](Engine::Core::World & /*world*/, double /*deltaTime*/,
+                                               std::size_t idx, hp1 &cop1, hp2 &cop2) {
+            REQUIRE(idx % 4 == 2);
+            REQUIRE(cop1.hp == static_cast<int>(idx));
+            REQUIRE(cop2.maxHp == static_cast<int>(idx));
+            visited++;
+        });
+        REQUIRE(visited == entities / 4);
+    }
+}
+
+TEST_CASE("Cached queries", "[World]")
+{
+    // the cached queries keep a reference to their World, which never moves
+    STATIC_REQUIRE_FALSE(std::is_move_constructible_v<Engine::Core::World>);
+    STATIC_REQUIRE_FALSE(std::is_move_assignable_v<Engine::Core::World>);
+    Engine::Core::World world;
+
+    world.registerComponents<hp1, hp2>();
+
+    auto entity = world.createEntity();
+    auto entity2 = world.createEntity();
+
+    world.addComponentToEntity(entity, hp1 {1});
+    world.addComponentToEntity(entity, hp2 {1});
+    world.addComponentToEntity(entity2, hp1 {1});
+
+    auto &query = world.registerQuery<hp1, hp2>();
+
+    SECTION("The query is registered once and filled with the existing entities")
+    {
+        REQUIRE(&query == &world.registerQuery<hp1, hp2>());
+        REQUIRE(query.size() == 1);
+        REQUIRE(query.contains(entity));
+    }
+    SECTION("Structural changes update the matching list")
+    {
+        world.emplaceComponentToEntity<hp2>(entity2, 2);
+        REQUIRE(query.contains(entity2));
+        world.removeComponentFromEntity<hp1>(entity);
+        REQUIRE_FALSE(query.contains(entity));
+        world.killEntity(entity2);
+        REQUIRE(query.size() == 0);
+
+        auto entity3 = world.createEntity();
+
+        world.addComponentToEntity(entity3, hp1 {3});
+        world.addComponentToEntity(entity3, hp2 {3});
+        REQUIRE(query.contains(entity3));
+    }
+    SECTION("Entities can be killed while iterating")
+    {
+        world.addComponentToEntity(entity2, hp2 {1});
+
+        std::size_t visited = 0;
+        query.forEach(0, [&visited](Engine::Core::World &aWorld, double /*deltaTime*/, std::size_t idx, hp1 & /*cop1*/,
+                                    hp2 & /*cop2*/) {
+            aWorld.killEntity(idx);
+            visited++;
+        });
+        REQUIRE(visited == 2);
+        REQUIRE(query.size() == 0);
+    }
+    SECTION("Killing another entity while iterating visits each entity once")
+    {
+        world.addComponentToEntity(entity2, hp2 {1});
+        for (int idx = 0; idx < 4; idx++) {
+            auto other = world.createEntity();
+            world.addComponentToEntity(other, hp1 {1});
+            world.addComponentToEntity(other, hp2 {1});
+        }
+
+        std::vector<int> visits(16, 0);
+        query.forEach(0, [&visits, &query](Engine::Core::World &aWorld, double /*deltaTime*/, std::size_t idx,
+                                           hp1 & /*cop1*/, hp2 & /*cop2*/) {
+            visits[idx]++;
+            const auto first = query.getEntities().front();
+            if (first != idx) {
+                aWorld.killEntity(first);
+            }
+        });
+        REQUIRE(std::ranges::all_of(visits, [](int count) { return count <= 1; }));
+    }
+}
+
+struct DamageFunctor
+{
+        int applied = 0;
+
+        void operator()(Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1)
+        {
+            cop1.hp--;
+            applied++;
+        }
+};
+
+TEST_CASE("Query iteration", "[World]")
+{
+    Engine::Core::World world;
+
+    world.registerComponents<hp1, hp2>();
+    for (int idx = 0; idx < 10; idx++) {
+        auto entity = world.createEntity();
+
+        world.addComponentToEntity(entity, hp1 {idx});
+        if (idx % 2 == 0) {
+            world.addComponentToEntity(entity, hp2 {idx});
+        }
+    }
+
+    SECTION("Any callable is accepted")
+    {
+        DamageFunctor functor;
+
+        world.query<hp1>().forEach(0, std::ref(functor));
+        world.registerQuery<hp1>().forEach(0, std::ref(functor));
+        REQUIRE(functor.applied == 20);
+        REQUIRE(world.getComponent<hp1>().get(3).hp == 1);
+    }
+    SECTION("The smallest pool drives the iteration")
+    {
+        struct Projectile
+        {
+                int speed;
+        };
+        auto &projectiles = world.registerComponent<Projectile>(Engine::Core::ComponentStorage::SparseSet);
+
+        world.emplaceComponentToEntity<Projectile>(7, 2);
+        world.emplaceComponentToEntity<Projectile>(2, 3);
+        world.emplaceComponentToEntity<Projectile>(4, 4);
+        world.removeComponentFromEntity<hp2>(4);
+
+        std::vector<std::size_t> visited;
+        world.query<hp1, Projectile>().forEach(
+            0, [&visited](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t idx, hp1 &cop1,
+                          Projectile &projectile) {
+                cop1.hp += projectile.speed;
+                visited.push_back(idx);
+            });
+        REQUIRE(projectiles.count() == 3);
+        REQUIRE(visited == std::vector<std::size_t> {7, 2, 4});
+        REQUIRE(world.getComponent<hp1>().get(7).hp == 9);
+
+        visited.clear();
+        world.query<hp2, Projectile, hp1>().forEach(
+            0, [&visited](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t idx, hp2 & /*cop2*/,
+                          Projectile & /*projectile*/, hp1 & /*cop1*/) {
+                visited.push_back(idx);
+            });
+        REQUIRE(visited == std::vector<std::size_t> {2});
+        REQUIRE(world.registerQuery<hp1, Projectile>().size() == 3);
+
+        // killing the current entity swap-removes it from the driving pool, the entity moved in is still visited
+        visited.clear();
+        world.query<hp1, Projectile>().forEach(
+            0, [&visited](Engine::Core::World &ecs, double /*deltaTime*/, std::size_t idx, hp1 & /*cop1*/,
+                          Projectile & /*projectile*/) {
+                visited.push_back(idx);
+                ecs.killEntity(idx);
+            });
+        REQUIRE(visited == std::vector<std::size_t> {7, 2, 4});
+        REQUIRE(projectiles.count() == 0);
+    }
+    SECTION("The std::function overload is kept")
+    {
+        int visited = 0;
+        std::function<void(Engine::Core::World &, double, std::size_t, hp1 &, hp2 &)> func =
+            [&visited](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 & /*cop1*/,
+                       hp2 & /*cop2*/) {
+                visited++;
+            };
+
+        world.query<hp1, hp2>().forEach(0, func);
+        world.registerQuery<hp1, hp2>().forEach(0, func);
+        REQUIRE(visited == 10);
+    }
+    SECTION("With, Without and Optional filter the entities")
+    {
+        using Engine::Core::Optional;
+        using Engine::Core::With;
+        using Engine::Core::Without;
+
+        std::vector<std::size_t> visited;
+        auto collect = [&visited](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t idx,
+                                  hp1 & /*cop1*/) {
+            visited.push_back(idx);
+        };
+
+        world.query<hp1, Without<hp2>>().forEach(0, collect);
+        REQUIRE(visited == std::vector<std::size_t> {1, 3, 5, 7, 9});
+
+        auto &cached = world.registerQuery<hp1, Without<hp2>>();
+        REQUIRE(cached.size() == 5);
+        world.addComponentToEntity(3, hp2 {});
+        world.removeComponentFromEntity<hp2>(4);
+        REQUIRE_FALSE(cached.contains(3));
+        REQUIRE(cached.contains(4));
+
+        int withMaxHp = 0;
+        int total = 0;
+        world.query<With<hp1>, Optional<hp2>>().forEach(
+            0, [&withMaxHp, &total](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/,
+                                    hp2 *cop2) {
+                total++;
+                withMaxHp += cop2 != nullptr ? 1 : 0;
+            });
+        REQUIRE(total == 10);
+        REQUIRE(withMaxHp == 5);
+
+        auto &withHp2 = world.registerQuery<hp1, hp2>();
+        world.removeComponent<hp2>();
+        REQUIRE(cached.size() == 10);
+        REQUIRE(withHp2.size() == 0);
+        world.registerComponent<hp2>();
+        world.addComponentToEntity(0, hp2 {});
+        REQUIRE(cached.size() == 9);
+        REQUIRE(withHp2.contains(0));
+    }
+}
+
+TEST_CASE("Archetype query filters", "[World]")
+{
+    using Engine::Core::Optional;
+    using Engine::Core::Without;
+
+    Engine::Core::World world(Engine::Core::WorldStorage::Archetypes);
+
+    world.registerComponents<hp1, hp2>();
+    for (int idx = 0; idx < 6; idx++) {
+        auto entity = world.createEntity();
+
+        world.addComponentToEntity(entity, hp1 {idx});
+        if (idx % 3 == 0) {
+            world.addComponentToEntity(entity, hp2 {idx});
+        }
+    }
+    int excluded = 0;
+    world.registerQuery<hp1, Without<hp2>>().forEach(
+        0, [&excluded](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 & /*cop1*/) {
+            excluded++;
+        });
+    REQUIRE(excluded == 4);
+
+    int sum = 0;
+    world.query<hp1, Optional<hp2>>().forEach(
+        0, [&sum](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 & /*cop1*/,
+                  hp2 *cop2) {
+            sum += cop2 != nullptr ? cop2->maxHp : 0;
+        });
+    REQUIRE(sum == 3);
+}
+
+TEST_CASE("Parallel queries", "[World]")
+{
+    constexpr std::size_t entities = 10000;
+    constexpr std::size_t grain = 64;
+    Engine::Core::JobSystem jobs(3);
+
+    SECTION("Every index is given to exactly one range")
+    {
+        std::vector<int> touched(entities, 0);
+
+        jobs.parallelFor(entities, grain, [&touched](std::size_t begin, std::size_t end) {
+            for (std::size_t idx = begin; idx < end; idx++) {
+                touched[idx]++;
+            }
+        });
+        REQUIRE(std::all_of(touched.begin(), touched.end(), [](int count) { return count == 1; }));
+        REQUIRE_THROWS_AS(jobs.parallelFor(entities, grain,
+                                           [](std::size_t begin, std::size_t /*end*/) {
+                                               if (begin == grain * 3) {
+                                                   throw std::runtime_error("range failed");
+                                               }
+                                           }),
+                          std::runtime_error);
+    }
+    SECTION("Each matching entity is visited once")
+    {
+        Engine::Core::World world;
+        world.registerComponents<hp1, hp2>();
+        auto created = world.createEntities(entities);
+        world.emplaceComponents<hp1>(created, 0);
+        world.emplaceComponents<hp2>(std::span(created).first(entities / 2), 0);
+
+        auto increment = [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1) {
+            cop1.hp++;
+        };
+        world.query<hp1, Engine::Core::Without<hp2>>().forEachParallel(0, increment, grain, jobs);
+        world.registerQuery<hp1>().forEachParallel(0, increment, grain, jobs);
+
+        auto &hps = world.getComponent<hp1>();
+        REQUIRE(hps.get(0).hp == 1);
+        REQUIRE(hps.get(entities - 1).hp == 2);
+        std::size_t total = 0;
+        for (std::size_t idx = 0; idx < entities; idx++) {
+            total += static_cast<std::size_t>(hps.get(idx).hp);
+        }
+        REQUIRE(total == entities + entities / 2);
+    }
+}
+
+TEST_CASE("Command buffers", "[World]")
+{
+    constexpr std::size_t entities = 1000;
+    Engine::Core::JobSystem jobs(3);
+    Engine::Core::World world;
+    world.registerComponents<hp1, hp2>();
+    auto created = world.createEntities(entities);
+    for (std::size_t idx = 0; idx < entities; idx++) {
+        world.emplaceComponentToEntity<hp1>(created[idx], static_cast<int>(idx));
+    }
+
+    SECTION("Parallel queries record and the flush replays")
+    {
+        world.query<hp1>().forEachParallel(
+            0,
+            [](Engine::Core::World &ecs, double /*deltaTime*/, std::size_t idx, hp1 &cop1) {
+                auto &commands = ecs.getCommandBuffer();
+                const auto entity = ecs.getEntity(idx);
+
+                if (cop1.hp % 2 == 0) {
+                    commands.emplaceComponentToEntity<hp2>(entity, cop1.hp);
+                } else if (cop1.hp % 5 == 0) {
+                    commands.killEntity(entity);
+                    commands.removeComponentFromEntity<hp1>(entity);
+                    commands.emplaceComponentToEntity<hp2>(commands.createEntity(), -cop1.hp);
+                }
+            },
+            16, jobs);
+        REQUIRE(world.getCurrentId() == entities);
+        REQUIRE(world.isAlive(created[5]));
+        world.flushCommands();
+
+        std::size_t even = 0;
+        std::size_t spawned = 0;
+        world.query<hp2>().forEach(
+            0, [&](Engine::Core::World &ecs, double /*deltaTime*/, std::size_t idx, hp2 &cop2) {
+                if (cop2.maxHp >= 0) {
+                    REQUIRE(ecs.getComponent<hp1>().get(idx).hp == cop2.maxHp);
+                    even++;
+                } else {
+                    REQUIRE_FALSE(ecs.hasComponents<hp1>(idx));
+                    spawned++;
+                }
+            });
+        REQUIRE(even == entities / 2);
+        REQUIRE(spawned == entities / 10);
+        REQUIRE_FALSE(world.isAlive(created[5]));
+        REQUIRE(world.isAlive(created[3]));
+        REQUIRE(world.getCommandBuffer().empty());
+    }
+    SECTION("The commands aimed at dead entities are dropped")
+    {
+        auto &commands = world.getCommandBuffer();
+
+        REQUIRE(&commands == &world.getCommandBuffer());
+        commands.emplaceComponentToEntity<hp2>(created[0], 1);
+        commands.killEntity(created[0]);
+        commands.killEntity(created[0]);
+        commands.emplaceComponentToEntity<hp2>(created[1], 1);
+        world.killEntity(created[1]);
+        REQUIRE_NOTHROW(world.flushCommands());
+        REQUIRE_FALSE(world.isAlive(created[0]));
+        REQUIRE(world.getComponent<hp2>().count() == 0);
+    }
+    SECTION("The last command recorded for an entity wins")
+    {
+        auto &commands = world.getCommandBuffer();
+
+        commands.removeComponentFromEntity<hp1>(created[0]);
+        commands.addComponentToEntity(created[0], hp1 {5});
+        commands.addComponentToEntity(created[1], hp1 {6});
+        commands.removeComponentFromEntity<hp1>(created[1]);
+        world.flushCommands();
+        REQUIRE(world.getComponent<hp1>().get(created[0]).hp == 5);
+        REQUIRE_FALSE(world.hasComponents<hp1>(created[1]));
+    }
+    SECTION("runSystems flushes once every system is done")
+    {
+        auto spawner = Engine::Core::createSystem<const hp1>(
+            world, "Spawner",
+            [](Engine::Core::World &ecs, double /*deltaTime*/, std::size_t /*idx*/, const hp1 &cop1) {
+                if (cop1.hp == 0) {
+                    ecs.getCommandBuffer().emplaceComponentToEntity<hp1>(ecs.getCommandBuffer().createEntity(), -1);
+                }
+            });
+        world.addSystem(spawner);
+        world.runSystems(0);
+        REQUIRE(world.getCurrentId() == entities + 1);
+        REQUIRE(world.getComponent<hp1>().get(entities).hp == -1);
+    }
+    SECTION("Systems with declared access can't change the structure directly")
+    {
+        auto spawner = Engine::Core::createSystem<const hp1>(
+            world, "Spawner",
+            [](Engine::Core::World &ecs, double /*deltaTime*/, std::size_t idx, const hp1 & /*cop1*/) {
+                ecs.killEntity(idx);
+            });
+        world.addSystem(spawner);
+        REQUIRE_THROWS_AS(world.runSystems(0), Engine::Core::WorldExceptionSystemsRunning);
+        REQUIRE(world.isAlive(created[0]));
+        REQUIRE_NOTHROW(world.killEntity(created[0]));
+    }
+}
+
+TEST_CASE("Job system", "[World]")
+{
+    Engine::Core::JobSystem jobs(2);
+
+    SECTION("Continuations run after the jobs they wait for")
+    {
+        std::atomic<int> step = 0;
+        auto first = jobs.spawn([&step]() { step = 1; });
+        auto second = jobs.spawn([]() {});
+        std::array parents {first, second};
+        auto last = jobs.spawnAfter(parents, [&step]() { step = step == 1 ? 2 : -1; });
+
+        jobs.wait(last);
+        REQUIRE(first.isDone());
+        REQUIRE(last.isDone());
+        REQUIRE(step == 2);
+        REQUIRE(Engine::Core::JobHandle().isDone());
+    }
+    SECTION("A failing job skips its continuations and rethrows in wait")
+    {
+        bool ran = false;
+        auto failing = jobs.spawn([]() { throw std::runtime_error("job failed"); });
+        auto next = jobs.spawnAfter(failing, [&ran]() { ran = true; });
+
+        REQUIRE_THROWS_AS(jobs.wait(next), std::runtime_error);
+        REQUIRE_FALSE(ran);
+    }
+    SECTION("Jobs waiting for jobs don't deadlock")
+    {
+        constexpr std::size_t children = 64;
+        std::atomic<std::size_t> done = 0;
+        std::vector<Engine::Core::JobHandle> roots;
+
+        // more waiting jobs than workers, each one has to run queued jobs while it waits
+        for (std::size_t root = 0; root < 4; root++) {
+            roots.push_back(jobs.spawn([&jobs, &done]() {
+                std::vector<Engine::Core::JobHandle> spawned;
+
+                for (std::size_t idx = 0; idx < children; idx++) {
+                    spawned.push_back(jobs.spawn([&done]() { done++; }));
+                }
+                for (const auto &child : spawned) {
+                    jobs.wait(child);
+                }
+            }));
+        }
+        for (const auto &root : roots) {
+            jobs.wait(root);
+        }
+        REQUIRE(done == 4 * children);
+    }
+    SECTION("The shared job system is configured before its first use")
+    {
+        static_cast<void>(Engine::Core::JobSystem::getShared());
+        REQUIRE_THROWS_AS(Engine::Core::JobSystem::configureShared(1),
+                          Engine::Core::JobSystemExceptionAlreadyStarted);
+    }
+}
+
+TEST_CASE("System scheduler", "[World]")
+{
+    Engine::Core::World world;
+    world.registerComponents<hp1, hp2>();
+    for (int idx = 0; idx < 4; idx++) {
+        auto entity = world.createEntity();
+        world.addComponentToEntity(entity, hp1 {idx});
+        world.addComponentToEntity(entity, hp2 {0});
+    }
+
+    auto damage = Engine::Core::createSystem<hp1>(
+        world, "Damage", [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1) {
+            cop1.hp--;
+        });
+    auto heal = Engine::Core::createSystem<const hp1, hp2>(
+        world, "Heal",
+        [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, const hp1 &cop1, hp2 &cop2) {
+            cop2.maxHp = cop1.hp;
+        });
+    auto regen = Engine::Core::createSystem<const hp1>(
+        world, "Regen",
+        [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, const hp1 & /*cop1*/) {});
+
+    SECTION("The access is inferred from the const components")
+    {
+        const auto hp1Id = Engine::Core::ComponentRegistry::getId<hp1>();
+        const auto hp2Id = Engine::Core::ComponentRegistry::getId<hp2>();
+
+        REQUIRE(heal.second->hasAccess());
+        REQUIRE(heal.second->getReads().test(hp1Id));
+        REQUIRE(heal.second->getWrites().test(hp2Id));
+        REQUIRE_FALSE(heal.second->getWrites().test(hp1Id));
+        REQUIRE_FALSE(heal.second->conflictsWith(*regen.second));
+        REQUIRE(damage.second->conflictsWith(*regen.second));
+    }
+    SECTION("Only the conflicting systems wait for each other")
+    {
+        world.addSystem(damage);
+        world.addSystem(heal);
+        world.addSystem(regen);
+        world.runSystems();
+
+        const auto &scheduler = world.getSystemScheduler();
+        REQUIRE(scheduler.dependsOn("Heal", "Damage"));
+        REQUIRE(scheduler.dependsOn("Regen", "Damage"));
+        REQUIRE_FALSE(scheduler.dependsOn("Regen", "Heal"));
+        REQUIRE(scheduler.getCriticalPathLength() == 2);
+        REQUIRE(world.getComponent<hp2>().get(3).maxHp == 2);
+    }
+    SECTION("Explicit constraints order the systems")
+    {
+        heal.second->runBefore("Damage");
+        regen.second->runAfter("Heal");
+        world.addSystem(damage);
+        world.addSystem(heal);
+        world.addSystem(regen);
+        world.runSystems();
+
+        const auto &scheduler = world.getSystemScheduler();
+        REQUIRE(scheduler.dependsOn("Damage", "Heal"));
+        REQUIRE(scheduler.dependsOn("Regen", "Heal"));
+        REQUIRE(world.getComponent<hp2>().get(3).maxHp == 3);
+    }
+    SECTION("A cycle of constraints is rejected")
+    {
+        damage.second->runBefore("Heal");
+        heal.second->runBefore("Damage");
+        world.addSystem(damage);
+        world.addSystem(heal);
+        REQUIRE_THROWS_AS(world.runSystems(), Engine::Core::SystemSchedulerExceptionCycle);
+    }
+    SECTION("A system without declared access runs alone")
+    {
+        auto classSystem = std::make_pair<std::string, std::unique_ptr<Engine::Core::System>>(
+            "MySystemClass", std::make_unique<MySystemClass<hp1, hp2>>(world));
+
+        world.addSystem(heal);
+        world.addSystem(regen);
+        world.addSystem(classSystem);
+        world.runSystems();
+        REQUIRE(world.getSystemScheduler().dependsOn("MySystemClass", "Heal"));
+        REQUIRE(world.getSystemScheduler().dependsOn("MySystemClass", "Regen"));
+        REQUIRE(world.getSystemScheduler().getCriticalPathLength() == 2);
+    }
+    SECTION("The stages run in order, the systems of a stage in the order they were added")
+    {
+        world.addSystem(regen, Engine::Core::Stage::Render);
+        world.addSystem(heal, Engine::Core::Stage::PostUpdate);
+        world.addSystem(damage, Engine::Core::Stage::PreUpdate);
+        world.runSystems();
+
+        const auto &scheduler = world.getSystemScheduler();
+        REQUIRE(scheduler.dependsOn("Heal", "Damage"));
+        REQUIRE(scheduler.dependsOn("Regen", "Heal"));
+        REQUIRE(scheduler.getCriticalPathLength() == 3);
+        REQUIRE(world.getComponent<hp2>().get(3).maxHp == 2);
+
+        std::string name = "Heal";
+        world.removeSystem(name);
+        REQUIRE_THROWS_AS(world.getSystem(name), Engine::Core::WorldExceptionSystemNotRegistered);
+        REQUIRE(world.getSystem("Regen").hasAccess());
+    }
+    SECTION("A deactivated system is skipped")
+    {
+        world.addSystem(damage);
+        world.addSystem(heal);
+        world.setSystemActive("Damage", false);
+        world.runSystems();
+        REQUIRE(world.getComponent<hp1>().get(3).hp == 3);
+        REQUIRE(world.getComponent<hp2>().get(3).maxHp == 3);
+        world.setSystemActive("Damage", true);
+        world.runSystems();
+        REQUIRE(world.getComponent<hp1>().get(3).hp == 2);
+    }
+}
+
+TEST_CASE("Tick rates", "[World]")
+{
+    SECTION("A fixed timestep catches up to its max steps")
+    {
+        Engine::Core::FixedTimestep timestep(10, 3);
+
+        REQUIRE(timestep.getStep() == 100);
+        REQUIRE(timestep.advance(250) == 2);
+        REQUIRE(timestep.getAlpha() == 0.5);
+        REQUIRE(timestep.advance(40) == 0);
+        REQUIRE(timestep.advance(1000) == 3);
+        REQUIRE(timestep.getAlpha() < 1);
+        REQUIRE(Engine::Core::FixedTimestep().advance(1000) == 1);
+        REQUIRE_THROWS_AS(Engine::Core::FixedTimestep(-1), Engine::Core::FixedTimestepException);
+    }
+    SECTION("Each system runs at its own rate")
+    {
+        Engine::Core::World world;
+        world.registerComponents<hp1, hp2>();
+        auto entity = world.createEntity();
+        world.addComponentToEntity(entity, hp1 {0});
+        world.addComponentToEntity(entity, hp2 {0});
+
+        double physicsTime = 0;
+        double renderTime = 0;
+        auto physics = Engine::Core::createSystem<hp1>(
+            world, "Physics",
+            [&physicsTime](Engine::Core::World & /*world*/, double deltaTime, std::size_t /*idx*/, hp1 &cop1) {
+                cop1.hp++;
+                physicsTime += deltaTime;
+            });
+        auto ai = Engine::Core::createSystem<hp2>(
+            world, "Ai", [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp2 &cop2) {
+                cop2.maxHp++;
+            });
+        auto render = Engine::Core::createSystem<const hp1>(
+            world, "Render",
+            [&renderTime](Engine::Core::World & /*world*/, double deltaTime, std::size_t /*idx*/,
+                          const hp1 & /*cop1*/) { renderTime += deltaTime; });
+        physics.second->setTickRate(50);
+        ai.second->setTickRate(10);
+        world.addSystem(physics);
+        world.addSystem(ai);
+        world.addSystem(render);
+
+        world.runSystems(110);
+        REQUIRE(world.getComponent<hp1>().get(entity).hp == 5);
+        REQUIRE(world.getComponent<hp2>().get(entity).maxHp == 1);
+        REQUIRE(physicsTime == 100);
+        REQUIRE(renderTime == 110);
+        REQUIRE(world.getAlpha() == 0.5);
+        world.runSystems(50);
+        REQUIRE(world.getComponent<hp1>().get(entity).hp == 8);
+        REQUIRE(world.getComponent<hp2>().get(entity).maxHp == 1);
+    }
+}
+
+TEST_CASE("Change detection", "[World]")
+{
+    Engine::Core::World world;
+    world.registerComponent<hp1>();
+    world.registerComponent<hp2>(Engine::Core::ComponentStorage::SparseSet);
+    auto created = world.createEntities(4);
+    for (const auto entity : created) {
+        world.emplaceComponentToEntity<hp1>(entity, 1);
+        world.emplaceComponentToEntity<hp2>(entity, 1);
+    }
+
+    SECTION("The ticks wrap around")
+    {
+        const Engine::Core::ChangeTicks ticks {0, 0xFFFFFFF0U, 5};
+
+        REQUIRE(ticks.isNewer(2));
+        REQUIRE(ticks.isNewer(0xFFFFFFF8U));
+        REQUIRE_FALSE(ticks.isNewer(0xFFFFFFF0U));
+        REQUIRE_FALSE(ticks.isNewer(6));
+    }
+    SECTION("A system only sees the changes since its last run")
+    {
+        std::size_t added = 0;
+        std::size_t changed = 0;
+        auto addedWatcher = Engine::Core::createSystem<Engine::Core::Added<hp2>>(
+            world, "AddedWatcher",
+            [&added](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/) { added++; });
+        auto changedWatcher = Engine::Core::createSystem<Engine::Core::Changed<hp1>>(
+            world, "ChangedWatcher",
+            [&changed](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/) { changed++; });
+        world.addSystem(addedWatcher);
+        world.addSystem(changedWatcher);
+
+        world.runSystems(0);
+        REQUIRE(added == 4);
+        REQUIRE(changed == 4);
+        world.runSystems(0);
+        REQUIRE(added == 4);
+        REQUIRE(changed == 4);
+        world.getComponent<hp1>()[created[1]].hp = 2;
+        world.getComponent<hp1>().get(created[2]).hp = 2;
+        world.removeComponentFromEntity<hp2>(created[3]);
+        world.emplaceComponentToEntity<hp2>(created[3], 2);
+        world.runSystems(0);
+        REQUIRE(added == 5);
+        REQUIRE(changed == 6);
+    }
+    SECTION("Only the mutable terms mark the components as changed")
+    {
+        std::size_t changed = 0;
+        auto writer = Engine::Core::createSystem<hp1, Engine::Core::With<hp2>>(
+            world, "Writer",
+            [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1) { cop1.hp++; });
+        auto peeker = Engine::Core::createSystem<const hp1>(
+            world, "Peeker",
+            [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, const hp1 & /*cop1*/) {});
+        auto reader = Engine::Core::createSystem<Engine::Core::Changed<hp1>>(
+            world, "Reader",
+            [&changed](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/) { changed++; });
+        world.removeComponentFromEntity<hp2>(created[0]);
+        world.addSystem(writer);
+        world.addSystem(peeker);
+        world.addSystem(reader);
+
+        world.runSystems(0);
+        REQUIRE(changed == 4);
+        world.runSystems(0);
+        REQUIRE(changed == 7);
+        world.setSystemActive("Writer", false);
+        world.runSystems(0);
+        REQUIRE(changed == 7);
+    }
+    SECTION("Outside of the systems every change counts")
+    {
+        std::size_t changed = 0;
+        world.query<Engine::Core::Changed<hp1>, const hp1>().forEach(
+            0, [&changed](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/,
+                          const hp1 & /*cop1*/) { changed++; });
+        REQUIRE(changed == 4);
+
+        Engine::Core::World archetypes(Engine::Core::WorldStorage::Archetypes);
+        archetypes.registerComponent<hp1>();
+        REQUIRE_THROWS_AS(archetypes.query<Engine::Core::Changed<hp1>>().forEach(
+                              0, [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/) {}),
+                          Engine::Core::WorldExceptionWrongStorage);
+    }
+}
+
+TEST_CASE("Tasks", "[World]")
+{
+    Engine::Core::World world;
+
+    SECTION("A task runs over the frames")
+    {
+        int counter = 0;
+        world.startTask(countFrames(world, counter, 3));
+        REQUIRE(counter == 0);
+        REQUIRE(world.getTasks().getTaskCount() == 1);
+        world.runSystems(0);
+        REQUIRE(counter == 1);
+        world.runSystems(0);
+        world.runSystems(0);
+        REQUIRE(counter == 3);
+        REQUIRE(world.getTasks().getTaskCount() == 1);
+        world.runSystems(0);
+        REQUIRE(world.getTasks().getTaskCount() == 0);
+    }
+    SECTION("Timers wait for the time given to runSystems")
+    {
+        bool done = false;
+        world.startTask(waitTime(world, 100, done));
+        world.runSystems(60);
+        world.runSystems(60);
+        REQUIRE_FALSE(done);
+        world.runSystems(60);
+        REQUIRE(done);
+    }
+    SECTION("Tasks wait for the events pushed meanwhile")
+    {
+        auto &events = world.getEventManager();
+        int value = 0;
+        events.initEventHandler<TaskEvent>();
+        events.pushEvent(TaskEvent {1});
+        world.runSystems(0);
+        world.startTask(waitEvent(world, value));
+        world.runSystems(0);
+        world.runSystems(0);
+        REQUIRE(value == 0);
+        events.pushEvent(TaskEvent {2});
+        world.runSystems(0);
+        REQUIRE(value == 2);
+        events.keepEventsAndClear<>();
+    }
+    SECTION("Tasks wait for jobs")
+    {
+        Engine::Core::JobSystem jobs(1);
+        int asset = 0;
+        world.startTask(loadAsset(world, jobs, asset));
+        for (std::size_t frame = 0; asset == 0 && frame < 1000000; frame++) {
+            world.runSystems(0);
+        }
+        REQUIRE(asset == 42);
+        REQUIRE(world.getTasks().getTaskCount() == 0);
+    }
+    SECTION("The frames of the tasks are recycled")
+    {
+        int counter = 0;
+        for (int idx = 0; idx < 1000; idx++) {
+            world.startTask(countFrames(world, counter, 1));
+        }
+        world.runSystems(0);
+        world.runSystems(0);
+        const auto reserved = Engine::Core::TaskPool::getShared().getReservedBlocks();
+        for (int idx = 0; idx < 1000; idx++) {
+            world.startTask(countFrames(world, counter, 1));
+        }
+        world.runSystems(0);
+        world.runSystems(0);
+        REQUIRE(counter == 2000);
+        REQUIRE(Engine::Core::TaskPool::getShared().getReservedBlocks() == reserved);
+    }
+    SECTION("A failing task doesn't stop the other ones")
+    {
+        int counter = 0;
+        world.startTask(failAfterAFrame(world));
+        world.startTask(countFrames(world, counter, 5));
+        world.runSystems(0);
+        REQUIRE_THROWS_AS(world.runSystems(0), std::runtime_error);
+        REQUIRE(counter == 2);
+        REQUIRE(world.getTasks().getTaskCount() == 1);
+    }
+}
+
+TEST_CASE("Running the worlds", "[App]")
+{
+    Engine::App app;
+    Engine::Core::JobSystem jobs(2);
+    for (std::size_t key = 0; key < 3; key++) {
+        auto &added = app.addWorld(key);
+        added->registerComponent<hp1>();
+        added->addComponentToEntity(added->createEntity(), hp1 {0});
+        auto counter = Engine::Core::createSystem<hp1>(
+            *added, "Counter",
+            [key](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1) {
+                if (key == 2 && cop1.hp == 1) {
+                    throw std::runtime_error("world failed");
+                }
+                cop1.hp++;
+            });
+        added->addSystem(counter);
+    }
+    auto ticks = [&app](std::size_t key) { return app[key]->getComponent<hp1>().get(0).hp; };
+    app.setTickRate(1, 10);
+
+    auto failures = app.runAll(50, jobs);
+    REQUIRE(failures.empty());
+    REQUIRE(ticks(0) == 1);
+    REQUIRE(ticks(1) == 0);
+    REQUIRE(ticks(2) == 1);
+    failures = app.runAll(150, jobs);
+    REQUIRE(failures.size() == 1);
+    REQUIRE(failures[0].first == 2);
+    REQUIRE_THROWS_AS(std::rethrow_exception(failures[0].second), std::runtime_error);
+    REQUIRE(ticks(0) == 2);
+    REQUIRE(ticks(1) == 2);
+
+    const std::array<std::size_t, 2> selected {0, 0};
+    REQUIRE(app.runAll(selected, 0, jobs).empty());
+    REQUIRE(ticks(0) == 3);
+    REQUIRE(ticks(1) == 2);
+    const std::array<std::size_t, 2> unknown {0, 7};
+    REQUIRE_THROWS_AS(app.runAll(unknown, 0, jobs), Engine::AppExceptionKeyNotFound);
+    REQUIRE(ticks(0) == 3);
+}
+
+TEST_CASE("Snapshots", "[World]")
+{
+    Engine::Core::World world;
+    world.registerComponent<hp1>();
+    auto first = world.createEntity();
+    world.addComponentToEntity(first, hp1 {0});
+    world.enableSnapshot<hp1>();
+
+    std::vector<int> seen;
+    auto simulation = Engine::Core::createSystem<hp1>(
+        world, "Simulation",
+        [](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, hp1 &cop1) { cop1.hp++; });
+    auto output = Engine::Core::createSystem<Engine::Core::Snapshot<hp1>>(
+        world, "Output",
+        [&seen](Engine::Core::World & /*world*/, double /*deltaTime*/, std::size_t /*idx*/, const hp1 &cop1) {
+            seen.push_back(cop1.hp);
+        });
+    world.addSystem(simulation);
+    world.addSystem(output);
+
+    world.runSystems(0);
+    REQUIRE_FALSE(world.getSystemScheduler().dependsOn("Output", "Simulation"));
+    REQUIRE(seen == std::vector<int> {0});
+    REQUIRE(world.getSnapshot<hp1>()[first].hp == 1);
+    auto second = world.createEntity();
+    world.addComponentToEntity(second, hp1 {10});
+    world.runSystems(0);
+    REQUIRE(seen == std::vector<int> {0, 1});
+    world.killEntity(first);
+    world.runSystems(0);
+    REQUIRE(seen == std::vector<int> {0, 1, 11});
+    REQUIRE_FALSE(world.getSnapshot<hp1>().contains(first));
+
+    REQUIRE_THROWS_AS(world.getSnapshot<hp2>(), Engine::Core::WorldExceptionNoSnapshot);
+    Engine::Core::World archetypes(Engine::Core::WorldStorage::Archetypes);
+    archetypes.registerComponent<hp1>();
+    REQUIRE_THROWS_AS(archetypes.enableSnapshot<hp1>(), Engine::Core::WorldExceptionWrongStorage);
+
+    Engine::Core::World removed;
+    removed.registerComponent<hp2>();
+    removed.enableSnapshot<hp2>();
+    removed.removeComponent<hp2>();
+    removed.runSystems(0);
+    REQUIRE_THROWS_AS(removed.getSnapshot<hp2>(), Engine::Core::WorldExceptionNoSnapshot);
+    removed.registerComponent<hp2>();
+    auto entity = removed.createEntity();
+    removed.addComponentToEntity(entity, hp2 {3});
+    removed.enableSnapshot<hp2>();
+    removed.runSystems(0);
+    REQUIRE(removed.getSnapshot<hp2>()[entity].maxHp == 3);
+}
+
+TEST_CASE("Event handler", "[Event]")
+{
+    Engine::Event::EventHandler<TaskEvent> handler;
+
+    SECTION("The events pushed from many threads are drained in order per thread")
+    {
+        constexpr int producers = 4;
+        constexpr int pushes = 10000;
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; producer++) {
+            threads.emplace_back([&handler, producer]() {
+                for (int idx = 0; idx < pushes; idx++) {
+                    handler.pushEvent(TaskEvent {producer * pushes + idx});
+                }
+            });
+        }
+        while (handler.getEvents().size() < static_cast<std::size_t>(producers * pushes)) {
+            handler.drain();
+            std::this_thread::yield();
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        std::vector<int> last(producers, -1);
+        for (const auto &event : handler.getEvents()) {
+            const auto producer = static_cast<std::size_t>(event.value / pushes);
+            REQUIRE(event.value > last[producer]);
+            last[producer] = event.value;
+        }
+        REQUIRE(handler.drain().empty());
+    }
+    SECTION("The getters never drain")
+    {
+        handler.pushEvent(TaskEvent {1});
+        REQUIRE(handler.getEvents().empty());
+        REQUIRE(std::as_const(handler).getEvents().empty());
+        handler.removeEvent(0);
+        REQUIRE(handler.drain().size() == 1);
+        REQUIRE(handler.getEvents().front().value == 1);
+    }
+    SECTION("Clearing drops the events not drained yet")
+    {
+        handler.pushEvent(TaskEvent {1});
+        handler.pushEvent(TaskEvent {2});
+        REQUIRE(handler.drain().size() == 2);
+        handler.pushEvent(TaskEvent {3});
+        REQUIRE(handler.getEvents().size() == 2);
+        REQUIRE(handler.drain().size() == 1);
+        handler.removeEvent(0);
+        REQUIRE(handler.getEvents().front().value == 2);
+        handler.pushEvent(TaskEvent {4});
+        handler.clearEvents();
+        REQUIRE(handler.getEvents().empty());
+    }
+}
+
+TEST_CASE("Event channels", "[Event]")
+{
+    SECTION("The events are read during the frame after the one they were pushed in")
+    {
+        Engine::Event::EventChannel<TaskEvent> channel;
+        channel.push(TaskEvent {1});
+        channel.push(TaskEvent {2});
+        REQUIRE(channel.read().empty());
+        channel.swap();
+        REQUIRE(channel.read().size() == 2);
+        REQUIRE(channel.read()[1].value == 2);
+        REQUIRE(channel.readLate().empty());
+        channel.push(TaskEvent {3});
+        channel.swap();
+        REQUIRE(channel.read().size() == 1);
+        channel.swap();
+        REQUIRE(channel.read().empty());
+    }
+    SECTION("Late readers see the events one more frame")
+    {
+        Engine::Event::EventChannel<TaskEvent> channel(Engine::Event::EventLifetime::TwoFrames);
+        channel.push(TaskEvent {1});
+        channel.swap();
+        channel.push(TaskEvent {2});
+        channel.swap();
+        REQUIRE(channel.read().front().value == 2);
+        REQUIRE(channel.readLate().front().value == 1);
+        channel.swap();
+        REQUIRE(channel.read().empty());
+        REQUIRE(channel.readLate().front().value == 2);
+    }
+    SECTION("The buffers are recycled")
+    {
+        Engine::Event::EventChannel<TaskEvent> channel;
+        std::vector<const TaskEvent *> buffers;
+        for (int frame = 0; frame < 4; frame++) {
+            for (int idx = 0; idx < 100; idx++) {
+                channel.push(TaskEvent {idx});
+            }
+            channel.swap();
+            buffers.push_back(channel.read().data());
+        }
+        REQUIRE(buffers[0] == buffers[2]);
+        REQUIRE(buffers[1] == buffers[3]);
+    }
+    SECTION("The EventManager swaps every channel")
+    {
+        auto &events = Engine::Event::EventManager::getInstance();
+        REQUIRE_THROWS_AS(events.getChannel<TaskEvent>(), Engine::Event::EventManagerExceptionNoHandler);
+        events.initEventChannel<TaskEvent>();
+        events.getChannel<TaskEvent>().push(TaskEvent {1});
+        events.swapChannels();
+        REQUIRE(events.getChannel<TaskEvent>().read().size() == 1);
+        events.swapChannels();
+    }
+}
+
+TEST_CASE("Event subscribers", "[Event]")
+{
+    using Engine::Event::DispatchMode;
+    Engine::Event::EventHandler<TaskEvent> handler;
+    std::vector<int> calls;
+
+    SECTION("Immediate subscribers are called on push, by priority")
+    {
+        handler.subscribe([&calls](const TaskEvent &event) { calls.push_back(event.value); }, DispatchMode::Immediate,
+                          0);
+        handler.subscribe([&calls](const TaskEvent &event) { calls.push_back(-event.value); },
+                          DispatchMode::Immediate, 1);
+        handler.pushEvent(TaskEvent {3});
+        REQUIRE(calls == std::vector<int> {-3, 3});
+        REQUIRE(handler.drain().size() == 1);
+    }
+    SECTION("Batched subscribers get the queued events when dispatched")
+    {
+        handler.subscribe([&calls](const TaskEvent &event) { calls.push_back(event.value); }, DispatchMode::Batched,
+                          0);
+        handler.pushEvent(TaskEvent {1});
+        handler.pushEvent(TaskEvent {2});
+        REQUIRE(calls.empty());
+        handler.dispatch();
+        REQUIRE(calls == std::vector<int> {1, 2});
+    }
+    SECTION("Unsubscribed callbacks aren't called anymore, even from a running callback")
+    {
+        Engine::Event::SubscriptionHandle<TaskEvent> second {};
+        handler.subscribe(
+            [&handler, &second, &calls](const TaskEvent &event) {
+                calls.push_back(event.value);
+                handler.unsubscribe(second);
+            },
+            DispatchMode::Batched, 1);
+        second = handler.subscribe([&calls](const TaskEvent &event) { calls.push_back(-event.value); },
+                                   DispatchMode::Batched, 0);
+        handler.pushEvent(TaskEvent {1});
+        handler.dispatch();
+        REQUIRE(calls == std::vector<int> {1});
+        REQUIRE_FALSE(handler.unsubscribe(second));
+        const auto third = handler.subscribe([](const TaskEvent & /*event*/) {}, DispatchMode::Batched, 0);
+        REQUIRE(third.slot == second.slot);
+        REQUIRE_FALSE(handler.unsubscribe(second));
+        REQUIRE(handler.unsubscribe(third));
+    }
+    SECTION("Pushing from several threads after an unsubscribe only reads the subscriptions")
+    {
+        std::atomic<int> called = 0;
+        Engine::Event::SubscriptionHandle<TaskEvent> self {};
+        self = handler.subscribe([&handler, &self](const TaskEvent & /*event*/) { handler.unsubscribe(self); },
+                                 DispatchMode::Immediate, 1);
+        handler.subscribe([&called](const TaskEvent & /*event*/) { called++; }, DispatchMode::Immediate, 0);
+        handler.pushEvent(TaskEvent {0});
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < 4; producer++) {
+            threads.emplace_back([&handler]() {
+                for (int idx = 0; idx < 1000; idx++) {
+                    handler.pushEvent(TaskEvent {idx});
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        REQUIRE(called == 4001);
+        handler.dispatch();
+        const auto reused = handler.subscribe([](const TaskEvent & /*event*/) {}, DispatchMode::Batched, 0);
+        REQUIRE(reused.slot == self.slot);
+    }
+    SECTION("The EventManager dispatches by type")
+    {
+        auto &events = Engine::Event::EventManager::getInstance();
+        events.initEventHandler<TaskEvent>();
+        const auto handle = events.subscribe<TaskEvent>(
+            [&calls](const TaskEvent &event) { calls.push_back(event.value); }, DispatchMode::Batched);
+        events.pushEvent(TaskEvent {4});
+        events.dispatchEvents<TaskEvent>();
+        REQUIRE(calls == std::vector<int> {4});
+        REQUIRE(events.unsubscribe(handle));
+        events.dispatchEvents<TaskEvent>();
+        REQUIRE(calls.size() == 1);
+        events.keepEventsAndClear<>();
+    }
+}
+
+TEST_CASE("Event removal", "[Event]")
+{
+    using Engine::Event::RemovalMode;
+    Engine::Event::EventHandler<TaskEvent> handler;
+    const auto values = [&handler]() {
+        std::vector<int> result;
+        for (const auto &event : handler.getEvents()) {
+            result.push_back(event.value);
+        }
+        return result;
+    };
+    for (int idx = 0; idx < 6; idx++) {
+        handler.pushEvent(TaskEvent {idx});
+    }
+    handler.drain();
+
+    SECTION("Indexes are removed in one pass, in any order")
+    {
+        handler.removeEvents({4, 1, 4, 42, 0});
+        REQUIRE(values() == std::vector<int> {2, 3, 5});
+    }
+    SECTION("Swap-remove fills the holes with the last events")
+    {
+        handler.removeEvents({1, 5, 2}, RemovalMode::SwapRemove);
+        REQUIRE(values() == std::vector<int> {0, 3, 4});
+    }
+    SECTION("Events are filtered in place")
+    {
+        const auto odd = [](const TaskEvent &event) { return event.value % 2 == 1; };
+        REQUIRE(handler.removeEventsIf(odd) == 3);
+        REQUIRE(values() == std::vector<int> {0, 2, 4});
+        REQUIRE(handler.removeEventsIf([](const TaskEvent &event) { return event.value < 3; },
+                                       RemovalMode::SwapRemove) == 2);
+        REQUIRE(values() == std::vector<int> {4});
+    }
+    SECTION("The EventManager removes several events at once")
+    {
+        auto &events = Engine::Event::EventManager::getInstance();
+        events.initEventHandler<TaskEvent>();
+        for (int idx = 0; idx < 4; idx++) {
+            events.pushEvent(TaskEvent {idx});
+        }
+        events.drainEvents();
+        events.removeEvent<TaskEvent>({2, 0});
+        REQUIRE(events.getEventsByType<TaskEvent>().front().value == 1);
+        REQUIRE(events.removeEventsIf<TaskEvent>([](const TaskEvent &event) { return event.value == 3; }) == 1);
+        REQUIRE(events.getEventsByType<TaskEvent>().size() == 1);
+        events.keepEventsAndClear<>();
+    }
+}
+
+TEST_CASE("Event managers", "[Event]")
+{
+    using Engine::Event::EventManager;
+    Engine::Core::World first;
+    Engine::Core::World second;
+
+    SECTION("Event types get dense ids shared by every EventManager")
+    {
+        const auto id = EventManager::getId<TaskEvent>();
+        REQUIRE(EventManager::getId<const TaskEvent &>() == id);
+        REQUIRE(EventManager::getId<float>() != id);
+        REQUIRE(EventManager::getId(typeid(TaskEvent)) == id);
+        // a type first seen through its type_index, as when a plugin pushes it, keeps its id in every binary
+        const auto pluginId = EventManager::getId(typeid(long double));
+        REQUIRE(EventManager::getId<long double>() == pluginId);
+    }
+    SECTION("Each World has its own events")
+    {
+        first.getEventManager().initEventHandler<TaskEvent>();
+        REQUIRE_THROWS_AS(second.getEventManager().pushEvent(TaskEvent {1}),
+                          Engine::Event::EventManagerExceptionNoHandler);
+        second.getEventManager().initEventHandler<TaskEvent>();
+        first.getEventManager().pushEvent(TaskEvent {1});
+        first.runSystems(0);
+        second.runSystems(0);
+        REQUIRE(first.getEventManager().getEventsByType<TaskEvent>().size() == 1);
+        REQUIRE(second.getEventManager().getEventsByType<TaskEvent>().empty());
+        REQUIRE(&first.getEventManager() != &EventManager::getInstance());
+    }
+    SECTION("Out of a World, the events pushed are read back at once")
+    {
+        auto &instance = EventManager::getInstance();
+        instance.initEventHandler<TaskEvent>();
+        instance.pushEvent(TaskEvent {1});
+        REQUIRE(instance.getEventsByType<TaskEvent>().size() == 1);
+        instance.keepEventsAndClear<>();
+
+        first.getEventManager().initEventHandler<TaskEvent>();
+        first.getEventManager().pushEvent(TaskEvent {2});
+        REQUIRE(first.getEventManager().getEventsByType<TaskEvent>().empty());
+        first.runSystems(0);
+        REQUIRE(first.getEventManager().getEventsByType<TaskEvent>().size() == 1);
+    }
+    SECTION("A World swaps its channels at the end of runSystems")
+    {
+        auto &events = first.getEventManager();
+        events.initEventChannel<TaskEvent>();
+        events.getChannel<TaskEvent>().push(TaskEvent {1});
+        first.runSystems(0);
+        REQUIRE(events.getChannel<TaskEvent>().read().size() == 1);
+        first.runSystems(0);
+        REQUIRE(events.getChannel<TaskEvent>().read().empty());
+    }
+}
+
+TEST_CASE("ComponentRegistry", "[World]")
+{
+    const auto hp1Id = Engine::Core::ComponentRegistry::getId<hp1>();
+    const auto hp2Id = Engine::Core::ComponentRegistry::getId<hp2>();
+
+    REQUIRE(hp1Id != hp2Id);
+    REQUIRE(hp1Id == Engine::Core::ComponentRegistry::getId<const hp1>());
+    REQUIRE(hp1Id == Engine::Core::ComponentRegistry::getId<hp1 &>());
+    REQUIRE(hp1Id < Engine::Core::ComponentRegistry::getCount());
+    REQUIRE(hp2Id < Engine::Core::ComponentRegistry::getCount());
+    REQUIRE(hp1Id == Engine::Core::ComponentRegistry::getId(typeid(hp1)));
+    // a type first seen through its type_index, as when a plugin registers it, keeps its id in every binary
+    const auto pluginId = Engine::Core::ComponentRegistry::getId(typeid(long double));
+    REQUIRE(Engine::Core::ComponentRegistry::getId<long double>() == pluginId);
+
+    Engine::Core::World world;
+
+    REQUIRE_THROWS_AS(world.getComponent<hp1>(), Engine::Core::WorldExceptionComponentNotRegistered);
+    world.registerComponent<hp1>();
+    REQUIRE_THROWS_AS(world.registerComponent<hp1>(), Engine::Core::WorldExceptionComponentAlreadyRegistered);
+    REQUIRE_NOTHROW(world.getComponent<hp1>());
+    world.removeComponent<hp1>();
+    REQUIRE_THROWS_AS(world.getComponent<hp1>(), Engine::Core::WorldExceptionComponentNotRegistered);
+    REQUIRE_NOTHROW(world.createEntity());
+}
+
+TEST_CASE("SparseArray", "[SparseArray]")
+{
+    SECTION("Dense and SparseSet share the same contract")
+    {
+        for (auto storage : {Engine::Core::ComponentStorage::Dense, Engine::Core::ComponentStorage::SparseSet}) {
+            Engine::Core::SparseArray<hp1> array(storage);
+
+            array.init(4);
+            REQUIRE(array.size() == 5);
+            REQUIRE_FALSE(array.has(2));
+            array.emplace(2, 10);
+            array.set(4, hp1 {20});
+            REQUIRE(array.get(2).hp == 10);
+            REQUIRE(array[4].hp == 20);
+            REQUIRE(array.count() == 2);
+            array.erase(2);
+            REQUIRE_FALSE(array.has(2));
+            REQUIRE(array.get(4).hp == 20);
+            REQUIRE_THROWS_AS(array.get(2), Engine::Core::SparseArrayExceptionEmpty);
+            REQUIRE_FALSE(array.has(5));
+            REQUIRE_THROWS_AS(array.erase(5), Engine::Core::SparseArrayExceptionOutOfRange);
+        }
+    }
+    SECTION("SparseSet swap-removes and only visits live components")
+    {
+        Engine::Core::SparseArray<hp1> array(Engine::Core::ComponentStorage::SparseSet);
+        constexpr std::size_t entities = 1000;
+
+        array.init(entities - 1);
+        array.emplace(10, 1);
+        array.emplace(500, 2);
+        array.emplace(999, 3);
+        array.erase(10);
+        REQUIRE(array.packed().size() == 2);
+        REQUIRE(array.get(999).hp == 3);
+        REQUIRE(array.get(500).hp == 2);
+
+        std::size_t visited = 0;
+        array.forEach([&visited](std::size_t /*idx*/, hp1 &component) {
+            component.hp *= 10;
+            visited++;
+        });
+        REQUIRE(visited == 2);
+        REQUIRE(array.get(999).hp == 30);
+
+        std::vector<int> iterated;
+        for (auto &component : array) {
+            REQUIRE(component.has_value());
+            iterated.push_back(component->hp);
+        }
+        REQUIRE(iterated == std::vector<int> {30, 20});
+        REQUIRE(std::distance(std::as_const(array).cbegin(), std::as_const(array).cend()) == 2);
+    }
+    SECTION("World picks the storage per component")
+    {
+        Engine::Core::World world;
+        auto &sparse = world.registerComponent<hp1>(Engine::Core::ComponentStorage::SparseSet);
+        auto &dense = world.registerComponent<hp2>();
+
+        REQUIRE(sparse.getStorage() == Engine::Core::ComponentStorage::SparseSet);
+        REQUIRE(dense.getStorage() == Engine::Core::ComponentStorage::Dense);
+
+        auto entity = world.createEntity();
+        auto entity2 = world.createEntity();
+
+        world.addComponentToEntity(entity2, hp1 {5});
+        world.addComponentToEntity(entity2, hp2 {5});
+        world.addComponentToEntity(entity, hp2 {5});
+        REQUIRE(world.hasComponents<hp1, hp2>(entity2));
+        REQUIRE_FALSE(world.hasComponents<hp1, hp2>(entity));
+        world.killEntity(entity2);
+        REQUIRE_FALSE(world.hasComponents<hp1>(entity2));
+        REQUIRE(sparse.count() == 0);
+    }
+}
+
+TEST_CASE("Signature", "[World]")
+{
+    using Engine::Core::Signature;
+
+    SECTION("Filter keeps the signatures containing the mask")
+    {
+        constexpr std::size_t highBit = Signature::capacity - 1;
+        std::vector<Signature> signatures {Signature::from(1, 3), Signature::from(3), Signature::from(1, 3, highBit),
+                                           Signature(), Signature::from(1, 2, 3)};
+        std::vector<std::size_t> matches;
+
+        Signature::filter(signatures, Signature::from(1, 3), matches);
+        REQUIRE(matches == std::vector<std::size_t> {0, 2, 4});
+        matches.clear();
+        Signature::filter(signatures, Signature::from(highBit), matches);
+        REQUIRE(matches == std::vector<std::size_t> {2});
+    }
+    SECTION("The World keeps one signature per entity")
+    {
+        Engine::Core::World world;
+        world.registerComponents<hp1, hp2>();
+        auto entity = world.createEntity();
+        auto entity2 = world.createEntity();
+        world.createEntity();
+
+        world.addComponentToEntity(entity, hp1 {1});
+        world.addComponentToEntity(entity2, hp1 {2});
+        world.addComponentToEntity(entity2, hp2 {2});
+        REQUIRE(world.filterEntities(world.getMask<hp1>()) == std::vector<std::size_t> {0, 1});
+        REQUIRE(world.filterEntities(world.getMask<hp1, hp2>()) == std::vector<std::size_t> {1});
+        world.removeComponentFromEntity<hp1>(entity2);
+        REQUIRE(world.filterEntities(world.getMask<hp1>()) == std::vector<std::size_t> {0});
+        world.killEntity(entity);
+        REQUIRE(world.filterEntities(world.getMask<hp1>()).empty());
+        REQUIRE(world.filterEntities(world.getMask<>()).size() == 2);
+    }
+}
+
 TEST_CASE("Plugin")
 {
     Engine::Plugin::PluginLoader<TestPlugin> loader;